@@ -4,97 +4,2943 @@
 #include <cctype>
 #include <cerrno>
 #include <clocale>
+#include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "template.h"
+
 namespace {
 
 using std::ios_base;
 
+char const checkpointName[] { ".bigprojgen-checkpoint" };
+char const checkpointMagic[] { "BPGCKPT1" };
 char const cmakeListName[] { "CMakeLists.txt" };
 char const headerExt[] { ".h" };
+char const jbConfigsMakefileName[] { "JbConfigs.mk" };
+char const jbMakefileName[] { "JbMakefile" };
+char const libExt[] { ".a" };
 char const libNamePostfix[] { "core" };
+char const manifestMagic[] { "bigprojgen-manifest 1" };
+char const manifestName[] { "bigprojgen.manifest" };
+char const nonHarmfulMakefileName[] { "NonHarmful.mk" };
+char const objExt[] { ".o" };
+char const recursiveMakefileName[] { "Recursive.mk" };
 char const srcExt[] { ".cpp" };
+int const defaultFilesPerDir { 100 };
 int const filePrefixLen { 5 };
 int const headerExtLen = sizeof headerExt - 1;
 ios_base::iostate const osExceptions { ios_base::badbit | ios_base::eofbit | ios_base::failbit };
 
-std::string MODULES;
-std::vector<std::string> Enums;
-std::vector<std::string> Includes;
-std::vector<std::string> NameBases;
+std::string MODULES;
+std::vector<std::string> Enums;
+std::vector<std::string> Includes;
+std::vector<std::string> NameBases;
+// Directory of each module in NameBases, relative to the top.
+std::vector<std::string> ModuleDirs;
+std::default_random_engine RandEngine;
+
+// A header or source produced by a generation run, in creation order.
+struct OutputEntry {
+	std::string path;
+	std::string content;
+};
+
+// When set, every header and source written is also appended here.
+std::vector<OutputEntry> * Recording { };
+
+// When set, headers and sources are taken from here, in the order they were
+// recorded, instead of being formatted again.
+struct Replay {
+	std::vector<OutputEntry> const * entries;
+	std::size_t next;
+};
+Replay * Replaying { };
+std::uint64_t BytesWritten { };
+
+// Build systems to emit for the generated project, see --emit.
+enum EmitFlavour : unsigned {
+	EmitCMake = 1,
+	EmitRecursive = 2,
+	EmitNonHarmful = 4,
+	EmitJb = 8
+};
+
+// A build configuration of the JB make system, see --jb-configs.
+struct JbConfig {
+	std::string name;
+	std::string cflags;
+};
+
+// Settings given as --options on the command line.
+struct RunOptions {
+	bool resume;
+	unsigned emit;
+	int year;
+	bool manifest;
+	bool evict;
+	std::vector<JbConfig> jbConfigs;
+};
+RunOptions Options { false, EmitCMake, 0, false, false, { } };
+
+// Content hash of a generated file, relative to the top of the tree.
+struct ManifestEntry {
+	std::string path;
+	std::uint64_t hash;
+	std::uint64_t size;
+};
+
+// When set, the hash of every file written is also appended here.
+std::vector<ManifestEntry> * Manifest { };
+
+// When set, the path of every file written is also appended here.
+std::vector<std::string> * Written { };
+
+// How a source of a cache scenario family member differs from the first
+// member of the family.
+enum SourceChange : char {
+	Identical,
+	CommentOnly,
+	Semantic
+};
+
+// Per TU of the whole tree, in generation order, the change to apply; empty
+// for ordinary generation.
+std::vector<SourceChange> SourceChanges;
+int SourceRevision { };
+
+// A completed leaf directory: the bytes written into it and the state of
+// the random engine after it, which is all a resumed run needs.
+struct LeafRecord {
+	std::uint64_t bytes;
+	std::string randState;
+};
+
+// Progress of the current generation run, appended to checkpointName in
+// the output directory and removed when the run completes.
+struct Checkpoint {
+	std::ofstream os;
+	std::string pending;
+	std::chrono::steady_clock::time_point lastFlush;
+	std::vector<LeafRecord> done;
+	std::size_t nextLeaf;
+	bool resuming;
+};
+Checkpoint * ActiveCheckpoint { };
+
+int GetCurrentYear()
+{
+	static int currentYear { Options.year };
+	if (currentYear == 0) {
+		using std::chrono::system_clock;
+		auto const now = system_clock::now();
+		auto const tt = system_clock::to_time_t(now);
+		struct std::tm tp;
+		if (localtime_r(&tt, &tp) == nullptr) {
+			throw std::runtime_error("problem with localtime_r");
+		}
+		currentYear = tp.tm_year + 1900;
+	}
+	return currentYear;
+}
+
+int RandInt(int low, int high)
+{
+	using Dist = std::uniform_int_distribution<int>;
+	static Dist uid { };
+	return uid(RandEngine, Dist::param_type { low, high });
+}
+
+std::string mkIncludeGuard(std::string const & fname)
+{
+	std::string incguard{fname};
+	for (auto & c : incguard) {
+		c = std::toupper(c);
+	}
+	incguard += "_H_";
+	for (int i = 0; i < 10; ++i) {
+		auto const c = RandInt(0, 9 + (('Z' - 'A') + 1));
+		if (c < 10) {
+			incguard += '0' + c;
+		} else {
+			incguard += 'A' + c - 10;
+		}
+	}
+	incguard += "_INCLUDED_";
+	return incguard;
+}
+
+std::string baseFilename(std::string const & namebase, int const fileNr){
+	std::string nr { std::to_string(fileNr) };
+	if (nr.length() < 3) {
+		nr.insert(0, 3 - nr.length(), '0');
+	}
+	return "file_" + namebase + "_" + nr;
+}
+
+// Default output templates, see template.h for the placeholder syntax.
+constexpr Template headerTpl { R"(#ifndef ~0
+#define ~0
+// Copyright © ~1 Bo Rydberg
+enum {
+	EnumValue_~2 = 1
+};
+class K~2 {
+public:
+	K~2();
+	void Work_~2();
+private:
+	int m_~2;
+};
+#endif // ~0
+)" };
+constexpr Template sourceHeadTpl { "// Copyright © ~0 Bo Rydberg\n" };
+constexpr Template sourceIncludeTpl { "#include \"~0\"\n" };
+constexpr Template sourceCtorTpl { "\nK~0::K~0() :\n\t\tm_~0()\n{\n" };
+constexpr Template sourceCtorLineTpl { "\tm_~0 += EnumValue_~1;\n" };
+constexpr Template sourceHeadRevisedTpl { "// Copyright © ~0 Bo Rydberg, revision ~1\n" };
+constexpr Template sourceTailTpl { R"(}
+
+void K~0::Work_~0()
+{
+	++m_~0;
+}
+)" };
+constexpr Template sourceTailRevisedTpl { R"(}
+
+void K~0::Work_~0()
+{
+	m_~0 += ~1;
+}
+)" };
+constexpr Template cmakeHeadTpl { "project(Prg~0)\nadd_library(~0~1\n" };
+constexpr Template cmakeSourceTpl { "\t~0\n" };
+constexpr Template cmakeIncludesTpl {
+	")\ntarget_include_directories(~0~1 PUBLIC \"$<BUILD_INTERFACE:${Prg~0_SOURCE_DIR}>\"\n" };
+constexpr Template cmakeIncludeTpl { "\t\"$<BUILD_INTERFACE:${Prg~0_SOURCE_DIR}>\"\n" };
+constexpr Template cmakeTailTpl { ")\n" };
+constexpr Template mainCMakeHeadTpl { "cmake_minimum_required(VERSION 2.8)\nproject(BigThing)\n" };
+constexpr Template mainCMakeSubdirTpl { "add_subdirectory(~0)\n" };
+
+// Recursive make, one Recursive.mk per leaf directory run from the top.
+constexpr Template recursiveHeadTpl { ".PHONY: all\nall : lib~0~1~2\nlib~0~1~2 :" };
+constexpr Template recursiveObjectTpl { " ~0~1" };
+constexpr Template recursiveArchiveTpl { "\n\tar cr $@ $^\nCPPFLAGS +=" };
+constexpr Template recursiveIncludeTpl { " -I~0~1" };
+constexpr Template recursiveDependTpl { "\n~0~1 : ~0~2 ~0~3" };
+constexpr Template makeTailTpl { "\n" };
+constexpr Template mainRecursiveMakefileTpl { R"(MODULES =~0
+
+.PHONY : all
+all :
+	for dir in $(MODULES); do \
+		cd $$dir && ${MAKE} -f ~1 all && cd -; \
+	done
+)" };
+
+// Non-recursive make, leaf NonHarmful.mk fragments included from the top.
+constexpr Template nonHarmfulHeadTpl { "LIBS += ~0/lib~1~2~3\n~0/lib~1~2~3 :" };
+constexpr Template nonHarmfulObjectTpl { " ~0/~1~2" };
+constexpr Template nonHarmfulArchiveTpl { "\n\tar cr $@ $^\n~0/%~1 : CPPFLAGS +=" };
+constexpr Template nonHarmfulIncludeTpl { " -I~0" };
+constexpr Template nonHarmfulDependTpl { "\n~0/~1~2 : ~0/~1~3 ~0/~1~4" };
+constexpr Template mainNonHarmfulMakefileTpl { R"(MODULES :=~0
+
+.PHONY : all
+all :
+
+# include the description for each module
+include $(patsubst %,%/~1,$(MODULES))
+
+all : $(LIBS)
+)" };
+
+// The JB make system by Johan Bezem: a JbMakefile in every directory and
+// the shared make includes below in make/.
+constexpr Template jbLocalMakefileTpl { "include $(YT_PBASE)/make/main.mk\n" };
+constexpr Template jbLeafIncludesTpl { "YT_LOCAL_CPPFLAGS :=" };
+constexpr Template jbLeafIncludeTpl { " -I$(YT_PBASE)/~0" };
+constexpr Template jbLeafMakefileTpl { "\ninclude $(YT_PBASE)/make/main.mk\n" };
+
+constexpr Template mainMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# Since 'make' is called recursively, every line in this Makefile
+# will get executed again every time, in every directory anew.
+# Therefore, we'll create a segment where several variables are 
+# determined and exported, since exporting them already makes them 
+# available to all child processes, and doesn't burden every run anew.
+# Test for the exported YT_OBJDIRNAME rather than for MAKELEVEL 0, so
+# the make system can also be started from another make (JbConfigs.mk).
+ifeq ($(origin YT_OBJDIRNAME),undefined)
+  include $(YT_PBASE)/make/level0.mk
+endif
+
+# Provide a different version of 'mkdir' depending on the platform
+ifeq (1,$(YT_USE_CMDEXE))
+  makedirectory=if not exist $(1) md $(subst /,\\,$(1))
+else
+  makedirectory=test -d $(1) || mkdir -p $(1)
+endif
+
+ifeq (,$(findstring $(YT_OBJDIRNAME),$(CURDIR)))
+  include $(YT_PBASE)/make/switch.mk
+else
+
+  # Compile the include path to refer to all include
+  # directories recursively; use $(wildcard to filter-out
+  # non-existing directories
+  export YT_INCLUDEPATH := $(strip $(wildcard $(YT_SRCVPATH)/include) $(YT_INCLUDEPATH))
+
+  # Now we can add the vpath directive for include files
+  # (Add other extensions as necessary). This vpath is only necessary
+  # to find/recognize the various *.h files specified as dependencies
+  # by the call to maxdepend, generating a set of *.d files that are
+  # included at the bottom of this file.
+  # See the definition of YT_CPPFLAGS for a description of all
+  # used directories.
+  vpath %.h $(YT_SRCVPATH) $(YT_INCLUDEPATH)
+
+  # Now set the various option flags; use YT_ as prefix
+  # to avoid name clashes with the default
+  # variable names
+  YT_CPPFLAGS := $(patsubst %,-I%,$(YT_INCLUDEPATH)) $(YT_LOCAL_CPPFLAGS)
+  YT_CFLAGS   := $(CFLAGS) $(YT_CFG_CFLAGS)
+
+  # Determine all sources, objects, etc.
+  # Be sure not to retain any pathnames
+  YT_SOURCES:=$(notdir $(wildcard $(YT_SRCVPATH)/*.cpp))
+
+  # Create the objects' filenames from the source filenames
+  YT_OBJECTS := $(patsubst %.cpp,%.obj,$(YT_SOURCES))
+
+  # Default target
+  .PHONY: all
+  all: RECURSE $(YT_OBJECTS)
+
+  # Clean target
+  .PHONY: clean
+  clean: RECURSE
+	$(YT_S)$(YT_RM) *.obj
+
+  # List_dirs will contain a space delimited list of all directories
+  # containing a Makefile.
+  list_dirs := $(dir $(wildcard $(YT_SRCVPATH)/*/JbMakefile))
+  # patsubst retains only the directory names, not the full paths
+  list_dirs := $(patsubst $(YT_SRCVPATH)/%,%,$(list_dirs))
+
+  # We define RECURSE as PHONY here, so we don't need to specify it in
+  # case we don't need recursion anymore (the else-clause for the following
+  # ifneq, when no more subdirectories containing a Makefile can be found).
+  # The directories are to be phony, in order to execute the
+  # recursion commands for all directories in all cases.
+  .PHONY: RECURSE $(list_dirs)
+
+  # If list_dirs is not empty, we need to recurse through one or more 
+  # subdirectories
+  ifneq ($(strip $(list_dirs)),)
+
+    # The RECURSE target can be used as a dependency for all targets
+    # that need to be made recursively. Put it as the first dependency
+    # for a depth-first usage.
+    RECURSE: $(list_dirs)
+
+    # To 'create' the subdirectories, we execute the commands listed,
+    # one of which is reexecuting 'make' in the target subdirectory '$@'
+    $(list_dirs):
+	+@$(call makedirectory,$(YT_OBJBASE)/$@)
+	+@echo Make[$(MAKELEVEL)]: $(patsubst %/,%,$@)
+	+@$(MAKE) -C $(YT_OBJBASE)/$(patsubst %/,%,$@) YT_SRCVPATH=$(YT_SRCVPATH)/$(patsubst %/,%,$@) YT_OBJBASE=$(YT_OBJBASE)/$(patsubst %/,%,$@) -f $(YT_SRCVPATH)/$(patsubst %/,%,$@)/JbMakefile --no-print-directory $(MAKECMDGOALS)
+    # Watch the empty line before the endif, otherwise it would be an (illegal)
+    # part of the commands to $(list_dirs): !!
+
+  endif
+
+  # Rules are mostly self-defined, since different compilers
+  # have different customs. So here we clear the list of implicit
+  # pattern rules and known suffixes.
+  .SUFFIXES:
+  # A .SUFFIXES: rule with extensions apparently only means anything 
+  # to old style suffix rules, but we define it anyway
+  # For now we only recognize C++-files.
+  .SUFFIXES: .cpp
+
+  vpath %.cpp $(YT_SRCVPATH)
+
+  %.obj: %.cpp
+	@echo .cpp   to $(YT_OBJEXT): $(notdir $<)
+	$(YT_S)$(YT_CC) -c $(subst $(YT_PBASE),$(YT_PBASE_WDL),$(YT_CPPFLAGS)) $(YT_CFLAGS) $(subst $(YT_PBASE),$(YT_PBASE_WDL),$<) -o $@
+
+endif
+)" };
+
+constexpr Template level0Mk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# A few helpful variables go here
+null:=
+space:=$(strip $(null)) $(strip $(null))
+
+# First, determine the name of the objects directory
+# This name should be in such a way unique, that a pathname
+# containing that string can only refer to an objects resp.
+# intermediates' directory. This is of vital importance for
+# the structure of the makefile.
+export YT_OBJDIRNAME:=objects
+
+# Record the directory from where we started, for later reference.
+export YT_STARTDIR := $(CURDIR)
+
+# Collect the components for the intermediates' directory
+# in YT_DIFFDIR. Start out with 'Im' to avoid starting with a dash
+# Use a simply expanded variable to enble self-references
+YT_DIFFDIR := Im
+
+# We must determine the operating system used.
+# Initialize first:
+YT_USE_WINDOWS:=0
+YT_USE_LINUX  :=0
+YT_USE_CMDEXE :=0
+YT_USE_BASH   :=0
+
+# If we are using Windows NT or later, the environment variable 
+# OS will be set to 'Windows_NT'
+ifneq (Windows_NT,$(OS))
+# We'll assume Linux for the time being
+  YT_USE_LINUX:=1
+  YT_NAME_PLATFORM:=LINUX
+  YT_USE_BASH:=1
+  YT_NAME_SHELL:=BASH
+else
+  YT_USE_WINDOWS:=1
+  YT_NAME_PLATFORM:=WINDOWS
+  # We need to differentiate between Cygwin using bash, and 
+  # Windows using CMD.EXE. For that, we look into the PATH variable, 
+  # and search for semicolons; only in CMD.EXE, semicolons are 
+  # allowed as path separators.
+  ifeq (;,$(findstring ;,$(PATH)))
+    YT_USE_CMDEXE:=1
+    YT_NAME_SHELL:=CMDEXE
+  else
+    YT_USE_BASH:=1
+    YT_NAME_SHELL:=BASH
+  endif
+endif
+
+# And now export our findings for all recursions
+export YT_USE_WINDOWS YT_USE_LINUX YT_USE_CMDEXE YT_USE_BASH
+export YT_NAME_PLATFORM YT_NAME_SHELL
+
+# Here we start with the host platform to define the architecure
+include $(YT_PBASE)/make/platform_$(YT_NAME_PLATFORM).mk
+
+# And then the shell's own specific definitions
+include $(YT_PBASE)/make/shell_$(YT_NAME_SHELL).mk
+
+# Now define the compiler (toolchain) platform
+# See if the configuration requires a specific implementation
+ifeq ($(origin YT_TC_SELECT),undefined)
+  # If not, check for a default
+  # CMD.EXE:
+  ifeq (1,$(YT_USE_CMDEXE))
+    # Take the newest supported VS
+    YT_TC_SELECT := VS
+  endif
+
+  # Bash:
+  ifeq (1,$(YT_USE_BASH))
+    # Take the newest supported GCC
+    YT_TC_SELECT := GCC
+  endif
+
+  # Test for a supported TC
+  ifeq ($(origin YT_TC_SELECT),undefined)
+    $(error No supported shell for default toolchain detection)
+  endif
+endif
+
+# We now look for the concrete implementation
+# We may find more than one, so sort the list and take the last one
+# (with the highest version number)
+# Using GNU make 3.81, the following line will work and be faster:
+YT_TC_MAKE_INCLUDE := $(lastword $(sort $(wildcard $(YT_PBASE)/make/tc_$(YT_TC_SELECT)*.mk)))
+# For pre-3.81, the following equivalent is necessary
+#YT_TC_MAKE_INCLUDE := $(word $(words $(sort $(wildcard $(YT_PBASE)/make/tc_$(YT_TC_SELECT)*.mk))), $(sort $(wildcard $(YT_PBASE)/make/tc_$(YT_TC_SELECT)*.mk)))
+
+ifeq (,$(strip $(YT_TC_MAKE_INCLUDE)))
+  $(error Toolchain make include not found.)
+endif
+
+# And include the selected file
+include $(YT_TC_MAKE_INCLUDE)
+
+# An optional build configuration adds its compiler flags
+# and its own component of the intermediates' directory
+ifneq (,$(YT_CFG_SELECT))
+  YT_CFG_MAKE_INCLUDE := $(wildcard $(YT_PBASE)/make/cfg_$(YT_CFG_SELECT).mk)
+  ifeq (,$(strip $(YT_CFG_MAKE_INCLUDE)))
+    $(error Configuration make include for $(YT_CFG_SELECT) not found.)
+  endif
+  include $(YT_CFG_MAKE_INCLUDE)
+endif
+
+# All components for the intermediates' directory have been collected,
+# so no make sure all make instances will inherit this value
+export YT_DIFFDIR
+)" };
+
+constexpr Template platformLinuxMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-pfLINUX
+)" };
+
+constexpr Template platformWindowsMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-pfWIN
+)" };
+
+constexpr Template shellBashMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+export YT_RM := rm -f
+
+# When using Cygwin on Windows, we have to take care of 
+# /cygdrive pathnames when they are to be used in windows tools
+ifeq (1,$(YT_USE_WINDOWS))
+  export YT_PBASE_WDL := $(word 2,$(subst /,$(space),$(YT_PBASE))):/$(subst $(space),/,$(wordlist 3,99,$(subst /,$(space),$(YT_PBASE))))
+else
+  # If using bash on Linux, we have no problem.
+  export YT_PBASE_WDL := $(YT_PBASE)
+endif
+)" };
+
+constexpr Template shellCmdexeMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+export YT_RM := del /q 2>NUL
+
+# We need to define all mandatory variables
+
+# For using DOS drive letters (With Drive Letters)
+# in bash-shells, we need:
+export YT_PBASE_WDL := $(YT_PBASE)
+)" };
+
+constexpr Template switchMk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+YT_OBJDIR := $(YT_PBASE)/$(YT_OBJDIRNAME)/$(YT_DIFFDIR)
+
+# Disable all built-in rules; we don't need them on this run
+.SUFFIXES:
+
+# The object directory is the only target here; since it's phony,
+# when the commands have been executed, it is considered built.
+# This calls make recursively, but now from the objects directory.
+.PHONY: $(YT_OBJDIR)
+$(YT_OBJDIR):
+	+@$(call makedirectory,$@)
+	+@echo Make : $@
+	+@$(MAKE) -C $@ -f $(CURDIR)/JbMakefile YT_SRCVPATH=$(CURDIR) YT_OBJBASE=$(YT_OBJDIR) --no-print-directory $(MAKECMDGOALS)
+
+# Since we'll provide just one rule, but a 'match-anything' rule,
+# when make tries to remake the makefiles involved, the rule will
+# also apply, and make would recursively call itself from the
+# same directory... Endless recursion results in chaos.
+JbMakefile : ; @:
+%.mk :: ;
+
+# No matter what goals are given, this dependency will make sure,
+# make is recursively called.
+% :: $(YT_OBJDIR) ; @:
+)" };
+
+constexpr Template tc_Gcc344Mk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# If environment variable CC is not defined, or defaulted by make,
+# use the GNU compiler frontend gcc.
+# Otherwise use the indicated compiler.
+ifeq (,$(strip $(filter-out undefined default,$(origin CC))))
+  export YT_CC := gcc
+else
+  export YT_CC := $(CC)
+endif
+
+# If shell_BASH.mk has set YT_PBASE_WDL for translating
+# Cygwin paths into DOS, we can take it back here
+# GCC will work with native pathnames just as well.
+export YT_PBASE_WDL := $(YT_PBASE)
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-tcGCC
+)" };
+
+constexpr Template tcVS9Mk { R"(###########################################################
+#
+# General make-include
+# Johan Bezem, JB Enterprises, © 2008.
+#
+# Prerequisites:
+#  - GNUmake   3.79.1 or higher
+#  - Bash      2.05a or higher
+#    or
+#  - CMD.EXE   Windows XP or higher
+#
+# Version 005.000
+# Saved under "005Differentiate.zip"
+
+# If environment variable CC is not defined, or defaulted by make,
+# use the Microsoft compiler frontend CL.EXE
+# Otherwise use the indicated compiler.
+ifeq (,$(strip $(filter-out undefined default,$(origin CC))))
+  export YT_CC := CL.EXE
+else
+  export YT_CC := $(CC)
+endif
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-tcVS
+)" };
+
+constexpr Template tcClangMk { R"(###########################################################
+# Toolchain make-include for clang, written by bigprojgen
+# after the example of tc_GCC344.mk
+
+# If environment variable CC is not defined, or defaulted by make,
+# use the LLVM compiler frontend clang++.
+# Otherwise use the indicated compiler, as tc_GCC344.mk does.
+ifeq (,$(strip $(filter-out undefined default,$(origin CC))))
+  export YT_CC := clang++
+else
+  export YT_CC := $(CC)
+endif
+
+export YT_PBASE_WDL := $(YT_PBASE)
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-tcCLANG
+)" };
+
+constexpr Template jbConfigMk { R"(###########################################################
+# Build configuration ~0, selected by YT_CFG_SELECT=~0
+
+export YT_CFG_CFLAGS := ~1
+
+# Augment the intermediates' directory
+YT_DIFFDIR := $(YT_DIFFDIR)-cfg~0
+)" };
+
+constexpr Template jbConfigsHeadTpl { R"(# Builds every configuration of the JB make system at once, each in
+# its own intermediates' directory under objects/, sharing the job slots
+# of this make: make -f JbConfigs.mk -j<jobs>
+YT_PBASE ?= $(CURDIR)
+
+CONFIGS :=)" };
+
+constexpr Template jbConfigsNameTpl { " ~0-~1" };
+
+constexpr Template jbConfigsBodyTpl { R"(
+
+# Toolchains which are not installed are left out
+ifeq (,$(shell command -v clang++ 2>/dev/null))
+  CONFIGS := $(filter-out clang-%,$(CONFIGS))
+endif
+
+.PHONY: all clean $(CONFIGS)
+all : $(CONFIGS)
+
+clean :
+	rm -rf $(YT_PBASE)/objects
+)" };
+
+constexpr Template jbConfigsRuleTpl { R"(
+~0-~1 :
+	+@$(MAKE) -f JbMakefile YT_PBASE=$(YT_PBASE) YT_TC_SELECT=~2 YT_CFG_SELECT=~1 --no-print-directory
+)" };
+
+// The templates in use, by name; --template=<name>=<file> replaces one.
+struct NamedTemplate {
+	char const * name;
+	Template const * tpl;
+};
+
+enum TemplateId {
+	HeaderTpl, SourceHeadTpl, SourceIncludeTpl, SourceCtorTpl, SourceCtorLineTpl,
+	SourceTailTpl, SourceHeadRevisedTpl, SourceTailRevisedTpl,
+	CMakeHeadTpl, CMakeSourceTpl, CMakeIncludesTpl, CMakeIncludeTpl,
+	CMakeTailTpl, MainCMakeHeadTpl, MainCMakeSubdirTpl,
+	RecursiveHeadTpl, RecursiveObjectTpl, RecursiveArchiveTpl, RecursiveIncludeTpl,
+	RecursiveDependTpl, MakeTailTpl, MainRecursiveTpl,
+	NonHarmfulHeadTpl, NonHarmfulObjectTpl, NonHarmfulArchiveTpl, NonHarmfulIncludeTpl,
+	NonHarmfulDependTpl, MainNonHarmfulTpl,
+	JbLocalTpl, JbLeafIncludesTpl, JbLeafIncludeTpl, JbLeafTpl,
+	JbMainMkTpl, JbLevel0MkTpl, JbPlatformLinuxMkTpl, JbPlatformWindowsMkTpl,
+	JbShellBashMkTpl, JbShellCmdexeMkTpl, JbSwitchMkTpl, JbTcGccMkTpl, JbTcVsMkTpl,
+	JbTcClangMkTpl, JbConfigMkTpl, JbConfigsHeadTpl, JbConfigsNameTpl, JbConfigsBodyTpl,
+	JbConfigsRuleTpl
+};
+
+NamedTemplate Templates[] {
+	{ "header", &headerTpl },
+	{ "source-head", &sourceHeadTpl },
+	{ "source-include", &sourceIncludeTpl },
+	{ "source-ctor", &sourceCtorTpl },
+	{ "source-ctor-line", &sourceCtorLineTpl },
+	{ "source-tail", &sourceTailTpl },
+	{ "source-head-revised", &sourceHeadRevisedTpl },
+	{ "source-tail-revised", &sourceTailRevisedTpl },
+	{ "cmake-head", &cmakeHeadTpl },
+	{ "cmake-source", &cmakeSourceTpl },
+	{ "cmake-includes", &cmakeIncludesTpl },
+	{ "cmake-include", &cmakeIncludeTpl },
+	{ "cmake-tail", &cmakeTailTpl },
+	{ "main-cmake-head", &mainCMakeHeadTpl },
+	{ "main-cmake-subdir", &mainCMakeSubdirTpl },
+	{ "recursive-head", &recursiveHeadTpl },
+	{ "recursive-object", &recursiveObjectTpl },
+	{ "recursive-archive", &recursiveArchiveTpl },
+	{ "recursive-include", &recursiveIncludeTpl },
+	{ "recursive-depend", &recursiveDependTpl },
+	{ "make-tail", &makeTailTpl },
+	{ "main-recursive", &mainRecursiveMakefileTpl },
+	{ "nonharmful-head", &nonHarmfulHeadTpl },
+	{ "nonharmful-object", &nonHarmfulObjectTpl },
+	{ "nonharmful-archive", &nonHarmfulArchiveTpl },
+	{ "nonharmful-include", &nonHarmfulIncludeTpl },
+	{ "nonharmful-depend", &nonHarmfulDependTpl },
+	{ "main-nonharmful", &mainNonHarmfulMakefileTpl },
+	{ "jb-local", &jbLocalMakefileTpl },
+	{ "jb-leaf-includes", &jbLeafIncludesTpl },
+	{ "jb-leaf-include", &jbLeafIncludeTpl },
+	{ "jb-leaf", &jbLeafMakefileTpl },
+	{ "jb-main-mk", &mainMk },
+	{ "jb-level0-mk", &level0Mk },
+	{ "jb-platform-linux-mk", &platformLinuxMk },
+	{ "jb-platform-windows-mk", &platformWindowsMk },
+	{ "jb-shell-bash-mk", &shellBashMk },
+	{ "jb-shell-cmdexe-mk", &shellCmdexeMk },
+	{ "jb-switch-mk", &switchMk },
+	{ "jb-tc-gcc-mk", &tc_Gcc344Mk },
+	{ "jb-tc-vs-mk", &tcVS9Mk },
+	{ "jb-tc-clang-mk", &tcClangMk },
+	{ "jb-config-mk", &jbConfigMk },
+	{ "jb-configs-head", &jbConfigsHeadTpl },
+	{ "jb-configs-name", &jbConfigsNameTpl },
+	{ "jb-configs-body", &jbConfigsBodyTpl },
+	{ "jb-configs-rule", &jbConfigsRuleTpl },
+};
+
+Template const & tpl(TemplateId const id)
+{
+	return *Templates[id].tpl;
+}
+
+// Custom templates and the text they refer to, kept for the whole run.
+std::deque<std::string> CustomTemplateTexts;
+std::deque<Template> CustomTemplates;
+
+void loadTemplate(std::string const & spec)
+{
+	auto const eq = spec.find('=');
+	if (eq == std::string::npos) {
+		throw std::runtime_error("expected --template=<name>=<file>, got " + spec);
+	}
+	std::string const name { spec.substr(0, eq) };
+	auto const named = std::find_if(std::begin(Templates), std::end(Templates),
+	                [&name](NamedTemplate const & nt) { return name == nt.name; });
+	if (named == std::end(Templates)) {
+		throw std::runtime_error("unknown template " + name);
+	}
+	std::ifstream ifs;
+	ifs.exceptions(ios_base::badbit);
+	ifs.open(spec.substr(eq + 1));
+	if (!ifs) {
+		throw std::runtime_error("could not read template file " + spec.substr(eq + 1));
+	}
+	std::ostringstream oss;
+	oss << ifs.rdbuf();
+	CustomTemplateTexts.push_back(oss.str());
+	auto const & text = CustomTemplateTexts.back();
+	CustomTemplates.push_back(Template(text.data(), text.size()));
+	if (CustomTemplates.back().nrArgs() > named->tpl->nrArgs()) {
+		throw std::runtime_error("template " + name + " uses more than "
+		                         + std::to_string(named->tpl->nrArgs()) + " arguments");
+	}
+	named->tpl = &CustomTemplates.back();
+}
+
+std::string const & currentYearText()
+{
+	static std::string const year { std::to_string(GetCurrentYear()) };
+	return year;
+}
+
+std::string formatHeader(std::string const & fname, std::string const & incguard)
+{
+	Template::Arg const name { fname.data() + filePrefixLen, fname.length() - filePrefixLen };
+	return render([&](auto & out) {
+		out(tpl(HeaderTpl), incguard, currentYearText(), name);
+	});
+}
+
+std::string formatSource(std::string const & fname)
+{
+	Template::Arg const name { fname.data() + filePrefixLen, fname.length() - filePrefixLen };
+	// The header of this source has already been added to Includes.
+	auto const change = SourceChanges.empty() ? Identical : SourceChanges.at(Includes.size() - 1);
+	std::string const revision { std::to_string(SourceRevision) };
+	return render([&](auto & out) {
+		// A comment only change keeps the line count, and with it the
+		// preprocessed output, unchanged.
+		if (change == CommentOnly) {
+			out(tpl(SourceHeadRevisedTpl), currentYearText(), revision);
+		} else {
+			out(tpl(SourceHeadTpl), currentYearText());
+		}
+		for (auto const & s : Includes) {
+			out(tpl(SourceIncludeTpl), s);
+		}
+		out(tpl(SourceCtorTpl), name);
+		for (auto const & s : Includes) {
+			auto const len = s.length() - filePrefixLen - headerExtLen;
+			out(tpl(SourceCtorLineTpl), name, Template::Arg(s.data() + filePrefixLen, len));
+		}
+		if (change == Semantic) {
+			out(tpl(SourceTailRevisedTpl), name, revision);
+		} else {
+			out(tpl(SourceTailTpl), name);
+		}
+	});
+}
+
+std::string formatCMakeLists(std::string const & namebase, std::vector<std::string> const & cppfiles)
+{
+	return render([&](auto & out) {
+		out(tpl(CMakeHeadTpl), namebase, libNamePostfix);
+		for (auto const & fname : cppfiles) {
+			out(tpl(CMakeSourceTpl), fname);
+		}
+		out(tpl(CMakeIncludesTpl), namebase, libNamePostfix);
+		for (auto const & nb : NameBases) {
+			out(tpl(CMakeIncludeTpl), nb);
+		}
+		out(tpl(CMakeTailTpl));
+	});
+}
+
+// Directory of the leaf module namebase, relative to the top.
+std::string moduleDir(std::string const & namebase)
+{
+	std::string dir;
+	for (std::string::size_type i { 1 }; i <= namebase.length(); ++i) {
+		dir += (i == 1 ? "directory_" : "/directory_") + namebase.substr(0, i);
+	}
+	return dir;
+}
+
+// Namebases of the leaf directories in the order mkDirRange generates them.
+void leafNamebases(int const depth, std::string const & namebase, char const a, char const z,
+                   std::vector<std::string> & leaves)
+{
+	if (depth <= 0) {
+		leaves.push_back(namebase);
+		return;
+	}
+	for (auto i = a; i <= z; ++i) {
+		leafNamebases(depth - 1, namebase + i, a, z, leaves);
+	}
+}
+
+std::string formatRecursiveMakefile(std::string const & namebase, std::vector<std::string> const & fnames,
+                                    std::vector<std::string> const & moduleDirs)
+{
+	std::string toTop;
+	for (std::string::size_type i { }; i != namebase.length(); ++i) {
+		toTop += "../";
+	}
+	return render([&](auto & out) {
+		out(tpl(RecursiveHeadTpl), namebase, libNamePostfix, libExt);
+		for (auto const & fname : fnames) {
+			out(tpl(RecursiveObjectTpl), fname, objExt);
+		}
+		out(tpl(RecursiveArchiveTpl));
+		for (auto const & dir : moduleDirs) {
+			out(tpl(RecursiveIncludeTpl), toTop, dir);
+		}
+		for (auto const & fname : fnames) {
+			out(tpl(RecursiveDependTpl), fname, objExt, srcExt, headerExt);
+		}
+		out(tpl(MakeTailTpl));
+	});
+}
+
+std::string formatNonHarmfulMakefile(std::string const & namebase, std::vector<std::string> const & fnames,
+                                     std::vector<std::string> const & moduleDirs)
+{
+	std::string const dir { moduleDir(namebase) };
+	return render([&](auto & out) {
+		out(tpl(NonHarmfulHeadTpl), dir, namebase, libNamePostfix, libExt);
+		for (auto const & fname : fnames) {
+			out(tpl(NonHarmfulObjectTpl), dir, fname, objExt);
+		}
+		out(tpl(NonHarmfulArchiveTpl), dir, objExt);
+		for (auto const & other : moduleDirs) {
+			out(tpl(NonHarmfulIncludeTpl), other);
+		}
+		for (auto const & fname : fnames) {
+			out(tpl(NonHarmfulDependTpl), dir, fname, objExt, srcExt, headerExt);
+		}
+		out(tpl(MakeTailTpl));
+	});
+}
+
+std::string formatJbLeafMakefile(std::vector<std::string> const & moduleDirs)
+{
+	return render([&](auto & out) {
+		out(tpl(JbLeafIncludesTpl));
+		for (auto const & dir : moduleDirs) {
+			out(tpl(JbLeafIncludeTpl), dir);
+		}
+		out(tpl(JbLeafTpl));
+	});
+}
+
+std::uint64_t rotl64(std::uint64_t const v, int const r)
+{
+	return v << r | v >> (64 - r);
+}
+
+std::uint64_t read64(unsigned char const * p)
+{
+	std::uint64_t v;
+	std::memcpy(&v, p, sizeof v);
+	return v;
+}
+
+std::uint32_t read32(unsigned char const * p)
+{
+	std::uint32_t v;
+	std::memcpy(&v, p, sizeof v);
+	return v;
+}
+
+// XXH64.  Its four independent accumulator lanes keep a superscalar core
+// busy without needing explicit SIMD, and it hashes at memory speed.
+std::uint64_t hash64(char const * data, std::size_t const len)
+{
+	std::uint64_t const p1 { 11400714785074694791ull }, p2 { 14029467366897019727ull },
+	                    p3 { 1609587929392839161ull }, p4 { 9650029242287828579ull },
+	                    p5 { 2870177450012600261ull };
+	auto const round = [=](std::uint64_t acc, std::uint64_t const input) {
+		return rotl64(acc + input * p2, 31) * p1;
+	};
+	auto p = reinterpret_cast<unsigned char const *>(data);
+	auto const end = p + len;
+	std::uint64_t h;
+	if (len >= 32) {
+		std::uint64_t v1 { p1 + p2 }, v2 { p2 }, v3 { 0 }, v4 { 0 - p1 };
+		for (; end - p >= 32; p += 32) {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+		}
+		h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+		for (auto const v : { v1, v2, v3, v4 }) {
+			h = (h ^ round(0, v)) * p1 + p4;
+		}
+	} else {
+		h = p5;
+	}
+	h += len;
+	for (; end - p >= 8; p += 8) {
+		h = rotl64(h ^ round(0, read64(p)), 27) * p1 + p4;
+	}
+	if (end - p >= 4) {
+		h = rotl64(h ^ read32(p) * p1, 23) * p2 + p3;
+		p += 4;
+	}
+	for (; p != end; ++p) {
+		h = rotl64(h ^ *p * p5, 11) * p1;
+	}
+	h = (h ^ h >> 33) * p2;
+	h = (h ^ h >> 29) * p3;
+	return h ^ h >> 32;
+}
+
+std::string hexHash(std::uint64_t const h)
+{
+	char buf[17];
+	std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(h));
+	return buf;
+}
+
+// Hashes a file through mmap; false if it cannot be read.
+bool hashFile(std::string const & path, std::uint64_t & hash, std::uint64_t & size)
+{
+	int const fd { open(path.c_str(), O_RDONLY) };
+	if (fd == -1) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		close(fd);
+		return false;
+	}
+	size = st.st_size;
+	if (size == 0) {
+		close(fd);
+		hash = hash64("", 0);
+		return true;
+	}
+	void * const data { mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+	close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	hash = hash64(static_cast<char const *>(data), size);
+	munmap(data, size);
+	return true;
+}
+
+// Every page cache operation fails the same way: a cache state that could
+// not be established must not be measured as if it had been.
+[[noreturn]] void throwCacheError(char const * what, std::string const & path, int const e)
+{
+	std::ostringstream oss;
+	oss << "`" << what << "' failed for " << path << " with errno " << e;
+	throw std::runtime_error(oss.str());
+}
+
+// Writes the file back if dirty and drops it from the page cache; needs no
+// privileges, unlike dropping all caches.
+void evictFile(std::string const & path)
+{
+	int const fd { open(path.c_str(), O_RDONLY) };
+	if (fd == -1) {
+		throwCacheError("open", path, errno);
+	}
+	int e { fdatasync(fd) == -1 ? errno : 0 };
+	char const * const what { e != 0 ? "fdatasync" : "posix_fadvise" };
+	if (e == 0) {
+		e = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	}
+	close(fd);
+	if (e != 0) {
+		throwCacheError(what, path, e);
+	}
+}
+
+std::string treePath(std::string const & path)
+{
+	return path.compare(0, 2, "./") == 0 ? path.substr(2) : path;
+}
+
+void mkDir(std::string const & dirLocation)
+{
+	if (mkdir(dirLocation.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) == -1
+	    && !(errno == EEXIST && ActiveCheckpoint != nullptr && ActiveCheckpoint->resuming)) {
+		auto const e = errno;
+		std::ostringstream oss;
+		oss << "`mkdir(\"" << dirLocation
+		    << "\", S_IRWXU | S_IRWXG | S_IRWXO)' failed with errno " << e;
+		throw std::runtime_error(oss.str());
+	}
+}
+
+void mkFileWithContent(std::string const & fileName, std::string const & fileContent)
+{
+	std::ofstream ofs;
+	ofs.exceptions(osExceptions);
+	ofs.open(fileName);
+	ofs << fileContent;
+	BytesWritten += fileContent.size();
+	if (Manifest != nullptr) {
+		Manifest->push_back(ManifestEntry { treePath(fileName),
+		                hash64(fileContent.data(), fileContent.size()), fileContent.size() });
+	}
+	if (Written != nullptr) {
+		Written->push_back(fileName);
+	}
+}
+
+template<typename... Args>
+void mkFileFromTemplate(std::string const & fileName, Template const & tpl, Args const &... args)
+{
+	mkFileWithContent(fileName, render([&](auto & out) { out(tpl, args...); }));
+}
+
+// Writes a header or source with the content format() returns, or the
+// recorded content when replaying.
+template<typename Format>
+void mkShapeFile(std::string const & fileName, Format const & format)
+{
+	if (Replaying != nullptr) {
+		auto const & entry = Replaying->entries->at(Replaying->next++);
+		if (entry.path != fileName) {
+			throw std::logic_error("replaying " + entry.path + " as " + fileName);
+		}
+		mkFileWithContent(fileName, entry.content);
+		return;
+	}
+	std::string content { format() };
+	mkFileWithContent(fileName, content);
+	if (Recording != nullptr) {
+		Recording->push_back(OutputEntry { fileName, std::move(content) });
+	}
+}
+
+void mkheader(std::string const & dirbase, std::string const & namebase, int const fileNr)
+{
+	std::string const fname(baseFilename(namebase, fileNr));
+	mkShapeFile(dirbase + "/" + fname + headerExt,
+	            [&fname] { return formatHeader(fname, mkIncludeGuard(fname)); });
+	Includes.push_back(fname + headerExt);
+}
+
+void mksources(std::string const & dirbase, std::string const & namebase,
+                int const fileNr, std::vector<std::string> & cppfiles)
+{
+	std::string const fname{baseFilename(namebase, fileNr)};
+	mkShapeFile(dirbase + "/" + fname + srcExt, [&fname] { return formatSource(fname); });
+	cppfiles.push_back(fname + srcExt);
+}
+
+void mkCMakeLists(std::string const & dirbase, std::string const & namebase,
+                std::vector<std::string> const & cppfiles)
+{
+	mkFileWithContent(dirbase + "/" + cmakeListName, formatCMakeLists(namebase, cppfiles));
+}
+
+// The leaf build descriptions of every flavour in Options.emit.  Earlier
+// modules, whose headers the sources include, are those in NameBases.
+void mkLeafMakefiles(std::string const & dirbase, std::string const & namebase, int const nrFiles)
+{
+	std::vector<std::string> fnames;
+	for (int i { }; i != nrFiles; ++i) {
+		fnames.push_back(baseFilename(namebase, i));
+	}
+	if (Options.emit & EmitRecursive) {
+		mkFileWithContent(dirbase + "/" + recursiveMakefileName, formatRecursiveMakefile(namebase, fnames, ModuleDirs));
+	}
+	if (Options.emit & EmitNonHarmful) {
+		mkFileWithContent(dirbase + "/" + nonHarmfulMakefileName, formatNonHarmfulMakefile(namebase, fnames, ModuleDirs));
+	}
+	if (Options.emit & EmitJb) {
+		mkFileWithContent(dirbase + "/" + jbMakefileName, formatJbLeafMakefile(ModuleDirs));
+	}
+}
+
+// Everything mkfiles writes into a leaf directory.
+std::vector<std::string> leafFiles(std::string const & dirbase, std::string const & namebase, int const nrFiles)
+{
+	std::vector<std::string> files;
+	for (int i { }; i != nrFiles; ++i) {
+		std::string const fname { dirbase + "/" + baseFilename(namebase, i) };
+		files.push_back(fname + headerExt);
+		files.push_back(fname + srcExt);
+	}
+	std::pair<unsigned, char const *> const flavourFiles[] {
+		{ EmitCMake, cmakeListName },
+		{ EmitRecursive, recursiveMakefileName },
+		{ EmitNonHarmful, nonHarmfulMakefileName },
+		{ EmitJb, jbMakefileName },
+	};
+	for (auto const & ff : flavourFiles) {
+		if (Options.emit & ff.first) {
+			files.push_back(dirbase + "/" + ff.second);
+		}
+	}
+	return files;
+}
+
+void putU32(std::string & out, std::uint32_t const v)
+{
+	for (int i { }; i != 4; ++i) {
+		out += static_cast<char>(v >> 8 * i);
+	}
+}
+
+void putU64(std::string & out, std::uint64_t const v)
+{
+	putU32(out, static_cast<std::uint32_t>(v));
+	putU32(out, static_cast<std::uint32_t>(v >> 32));
+}
+
+bool getU32(std::istream & is, std::uint32_t & v)
+{
+	unsigned char b[4];
+	if (!is.read(reinterpret_cast<char *>(b), sizeof b)) {
+		return false;
+	}
+	v = b[0] | b[1] << 8 | b[2] << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+	return true;
+}
+
+bool getU64(std::istream & is, std::uint64_t & v)
+{
+	std::uint32_t lo, hi;
+	if (!getU32(is, lo) || !getU32(is, hi)) {
+		return false;
+	}
+	v = lo | static_cast<std::uint64_t>(hi) << 32;
+	return true;
+}
+
+// Identifies everything the output depends on besides the random engine.
+std::string checkpointHeader(int const depth, char const dirRangeEnd, int const nrFiles)
+{
+	std::uint64_t fingerprint { 14695981039346656037ull };
+	for (auto const & nt : Templates) {
+		for (std::size_t i { }; i != nt.tpl->size(); ++i) {
+			fingerprint = (fingerprint ^ static_cast<unsigned char>(nt.tpl->text()[i])) * 1099511628211ull;
+		}
+	}
+	std::string header { checkpointMagic, sizeof checkpointMagic - 1 };
+	putU32(header, depth);
+	putU32(header, dirRangeEnd);
+	putU32(header, nrFiles);
+	putU64(header, fingerprint);
+	putU64(header, GetCurrentYear());
+	putU32(header, Options.emit);
+	return header;
+}
+
+std::string leafRecord(LeafRecord const & rec)
+{
+	std::string out;
+	putU64(out, rec.bytes);
+	putU32(out, rec.randState.size());
+	return out + rec.randState;
+}
+
+// Leaf records of an earlier run with the same header; a torn last record
+// is dropped.
+std::vector<LeafRecord> readCheckpoint(std::string const & header)
+{
+	std::ifstream is(checkpointName, ios_base::binary);
+	std::string found(header.size(), '\0');
+	if (!is.read(&found[0], found.size()) || found != header) {
+		throw std::runtime_error(std::string("no matching ") + checkpointName + " to resume from");
+	}
+	std::vector<LeafRecord> done;
+	LeafRecord rec;
+	std::uint32_t len;
+	while (getU64(is, rec.bytes) && getU32(is, len) && len < 4096) {
+		rec.randState.resize(len);
+		if (!is.read(&rec.randState[0], len)) {
+			break;
+		}
+		done.push_back(rec);
+	}
+	return done;
+}
+
+void flushCheckpoint(Checkpoint & cp)
+{
+	cp.os << cp.pending;
+	cp.os.flush();
+	cp.pending.clear();
+	cp.lastFlush = std::chrono::steady_clock::now();
+}
+
+void checkpointLeaf(Checkpoint & cp, std::uint64_t const bytes)
+{
+	std::ostringstream state;
+	state << RandEngine;
+	cp.pending += leafRecord(LeafRecord { bytes, state.str() });
+	if (std::chrono::steady_clock::now() - cp.lastFlush >= std::chrono::seconds(1)) {
+		flushCheckpoint(cp);
+	}
+}
+
+// Cheap check that a leaf of the interrupted run is complete: all its files
+// exist and add up to the recorded size.
+bool leafOnDisk(std::string const & dirbase, std::string const & namebase, int const nrFiles,
+                std::uint64_t const bytes)
+{
+	std::uint64_t found { };
+	struct stat st;
+	for (auto const & fname : leafFiles(dirbase, namebase, nrFiles)) {
+		if (stat(fname.c_str(), &st) == -1) {
+			return false;
+		}
+		found += st.st_size;
+	}
+	return found == bytes;
+}
+
+// Brings the generator state to where it was after a completed leaf,
+// without writing anything.
+void skipLeaf(std::string const & dirbase, std::string const & namebase, int const nrFiles,
+              LeafRecord const & rec)
+{
+	for (int i { }; i != nrFiles; ++i) {
+		Includes.push_back(baseFilename(namebase, i) + headerExt);
+	}
+	NameBases.push_back(namebase);
+	ModuleDirs.push_back(dirbase.substr(2));
+	MODULES += " " + ModuleDirs.back();
+	if (Manifest != nullptr) {
+		for (auto const & fname : leafFiles(dirbase, namebase, nrFiles)) {
+			ManifestEntry entry { treePath(fname), 0, 0 };
+			if (!hashFile(fname, entry.hash, entry.size)) {
+				throw std::runtime_error("could not read " + fname);
+			}
+			Manifest->push_back(entry);
+		}
+	}
+	if (Written != nullptr) {
+		for (auto const & fname : leafFiles(dirbase, namebase, nrFiles)) {
+			Written->push_back(fname);
+		}
+	}
+	std::istringstream state(rec.randState);
+	state >> RandEngine;
+}
+
+void mkfiles(std::string const & dirbase, std::string const & namebase, int const nrFiles)
+{
+	auto & cp = *ActiveCheckpoint;
+	auto const leaf = cp.nextLeaf++;
+	if (leaf < cp.done.size() && leafOnDisk(dirbase, namebase, nrFiles, cp.done[leaf].bytes)) {
+		return skipLeaf(dirbase, namebase, nrFiles, cp.done[leaf]);
+	}
+	auto const startBytes = BytesWritten;
+	std::vector<std::string> cppfiles;
+	for (int i { }; i != nrFiles; ++i) {
+		mkheader(dirbase, namebase, i);
+		mksources(dirbase, namebase, i, cppfiles);
+	}
+	if (Options.emit & EmitCMake) {
+		mkCMakeLists(dirbase, namebase, cppfiles);
+	}
+	mkLeafMakefiles(dirbase, namebase, nrFiles);
+	NameBases.push_back(namebase);
+	ModuleDirs.push_back(dirbase.substr(2));
+	MODULES += " " + ModuleDirs.back();
+	if (leaf >= cp.done.size()) {
+		checkpointLeaf(cp, BytesWritten - startBytes);
+	}
+}
+
+void mkDirRange(int const depth, std::string const & dirbase, std::string const & namebase,
+		char const a, char const z, int const nrFiles)
+{
+	if (depth <= 0) {
+		return mkfiles(dirbase, namebase, nrFiles);
+	}
+	if (Options.emit & EmitJb) {
+		mkFileFromTemplate(dirbase + "/" + jbMakefileName, tpl(JbLocalTpl));
+	}
+	std::string d(dirbase + "/directory_" + namebase);
+	auto const len = d.length();
+	for (auto i = a; i <= z; ++i) {
+		d.resize(len);
+		d += i;
+		mkDir(d);
+		mkDirRange(depth - 1, d, namebase + i, a, z, nrFiles);
+	}
+}
+
+void mkMainCMakeListsFile()
+{
+	std::vector<std::string> modules;
+	std::istringstream iss(MODULES);
+	std::string module;
+	while (iss >> module) {
+		modules.push_back(module);
+	}
+	mkFileWithContent(cmakeListName, render([&](auto & out) {
+		out(tpl(MainCMakeHeadTpl));
+		for (auto const & m : modules) {
+			out(tpl(MainCMakeSubdirTpl), m);
+		}
+	}));
+}
+
+void mkMainRecursiveMakefile()
+{
+	mkFileFromTemplate(recursiveMakefileName, tpl(MainRecursiveTpl), MODULES, recursiveMakefileName);
+}
+
+void mkMainNonHarmfulMakefile()
+{
+	mkFileFromTemplate(nonHarmfulMakefileName, tpl(MainNonHarmfulTpl), MODULES, nonHarmfulMakefileName);
+}
+
+void mkMainJbMakesystem(std::string basedir)
+{
+	basedir += "/make";
+	mkDir(basedir);
+	mkFileFromTemplate(basedir + "/tc_VS9.mk", tpl(JbTcVsMkTpl));
+	mkFileFromTemplate(basedir + "/tc_GCC344.mk", tpl(JbTcGccMkTpl));
+	mkFileFromTemplate(basedir + "/switch.mk", tpl(JbSwitchMkTpl));
+	mkFileFromTemplate(basedir + "/shell_CMDEXE.mk", tpl(JbShellCmdexeMkTpl));
+	mkFileFromTemplate(basedir + "/shell_BASH.mk", tpl(JbShellBashMkTpl));
+	mkFileFromTemplate(basedir + "/platform_WINDOWS.mk", tpl(JbPlatformWindowsMkTpl));
+	mkFileFromTemplate(basedir + "/platform_LINUX.mk", tpl(JbPlatformLinuxMkTpl));
+	mkFileFromTemplate(basedir + "/main.mk", tpl(JbMainMkTpl));
+	mkFileFromTemplate(basedir + "/level0.mk", tpl(JbLevel0MkTpl));
+	if (!Options.jbConfigs.empty()) {
+		mkFileFromTemplate(basedir + "/tc_CLANG.mk", tpl(JbTcClangMkTpl));
+	}
+	for (auto const & cfg : Options.jbConfigs) {
+		mkFileFromTemplate(basedir + "/cfg_" + cfg.name + ".mk", tpl(JbConfigMkTpl),
+		                   cfg.name, cfg.cflags);
+	}
+}
+
+// Every --jb-configs configuration with every toolchain, as targets of one
+// make, so the configurations are built concurrently from the same sources.
+void mkJbConfigsMakefile()
+{
+	std::pair<char const *, char const *> const toolchains[] {
+		{ "gcc", "GCC" },
+		{ "clang", "CLANG" },
+	};
+	mkFileWithContent(jbConfigsMakefileName, render([&](auto & out) {
+		out(tpl(JbConfigsHeadTpl));
+		for (auto const & tc : toolchains) {
+			for (auto const & cfg : Options.jbConfigs) {
+				out(tpl(JbConfigsNameTpl), tc.first, cfg.name);
+			}
+		}
+		out(tpl(JbConfigsBodyTpl));
+		for (auto const & tc : toolchains) {
+			for (auto const & cfg : Options.jbConfigs) {
+				out(tpl(JbConfigsRuleTpl), tc.first, cfg.name, tc.second);
+			}
+		}
+	}));
+}
+
+// The top level build descriptions of every flavour in Options.emit.
+void mkMainFiles()
+{
+	if (Options.emit & EmitCMake) {
+		mkMainCMakeListsFile();
+	}
+	if (Options.emit & EmitRecursive) {
+		mkMainRecursiveMakefile();
+	}
+	if (Options.emit & EmitNonHarmful) {
+		mkMainNonHarmfulMakefile();
+	}
+	if (Options.emit & EmitJb) {
+		mkMainJbMakesystem(".");
+		if (!Options.jbConfigs.empty()) {
+			mkJbConfigsMakefile();
+		}
+	}
+}
+
+// Merkle hash of every directory holding the files: a directory hashes
+// the sorted names and hashes of its files and subdirectories.
+std::map<std::string, std::uint64_t> treeHashes(std::vector<ManifestEntry> const & files)
+{
+	std::map<std::string, std::map<std::string, std::uint64_t>> children;
+	auto const parentOf = [](std::string const & path) {
+		auto const slash = path.rfind('/');
+		return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+	};
+	for (auto const & f : files) {
+		children[parentOf(f.path)][f.path.substr(f.path.rfind('/') + 1)] = f.hash;
+		for (std::string dir { parentOf(f.path) }; dir != "."; dir = parentOf(dir)) {
+			children[parentOf(dir)];
+			children[dir];
+		}
+	}
+	std::vector<std::string> dirs;
+	for (auto const & c : children) {
+		dirs.push_back(c.first);
+	}
+	// Deepest first, so subdirectories are complete before their parent.
+	std::stable_sort(dirs.begin(), dirs.end(), [](std::string const & a, std::string const & b) {
+		return (a == "." ? -1 : std::count(a.begin(), a.end(), '/'))
+		       > (b == "." ? -1 : std::count(b.begin(), b.end(), '/'));
+	});
+	std::map<std::string, std::uint64_t> hashes;
+	for (auto const & dir : dirs) {
+		std::string text;
+		for (auto const & c : children[dir]) {
+			text += c.first + '\0' + hexHash(c.second) + '\n';
+		}
+		hashes[dir] = hash64(text.data(), text.size());
+		if (dir != ".") {
+			children[parentOf(dir)][dir.substr(dir.rfind('/') + 1) + "/"] = hashes[dir];
+		}
+	}
+	return hashes;
+}
+
+// Lists the parameters, every file with its hash and size, and every
+// directory with its Merkle hash.
+void mkManifest(std::vector<ManifestEntry> const & files, int const depth, char const dirRangeEnd,
+                int const nrFiles)
+{
+	std::ostringstream os;
+	os.exceptions(osExceptions);
+	os << manifestMagic << "\n"
+	      "P " << depth << " " << dirRangeEnd << " " << nrFiles << " " << Options.emit << "\n";
+	for (auto const & f : files) {
+		os << "F " << hexHash(f.hash) << " " << f.size << " " << f.path << "\n";
+	}
+	for (auto const & d : treeHashes(files)) {
+		os << "D " << hexHash(d.second) << " " << d.first << "\n";
+	}
+	std::ofstream ofs;
+	ofs.exceptions(osExceptions);
+	ofs.open(manifestName);
+	ofs << os.str();
+}
+
+// One complete generation run into the current directory, starting from a
+// clean slate so that the output only depends on the arguments.
+//
+// Completed leaf directories are checkpointed; with resume, those a previous
+// interrupted run completed are checked and skipped, giving the same tree as
+// an uninterrupted run.
+void generate(int const depth, char const dirRangeEnd, int const nrFiles, bool const resume)
+{
+	MODULES.clear();
+	Includes.clear();
+	NameBases.clear();
+	ModuleDirs.clear();
+	RandEngine.seed();
+	std::string const header { checkpointHeader(depth, dirRangeEnd, nrFiles) };
+	Checkpoint cp { };
+	struct stat st;
+	if (!resume && stat(checkpointName, &st) == 0) {
+		throw std::runtime_error(std::string("found ") + checkpointName + " of an interrupted run;"
+		                         " repeat it with --resume, or remove the checkpoint to start over");
+	}
+	if (resume) {
+		cp.done = readCheckpoint(header);
+		cp.resuming = true;
+		std::cerr << "Resuming after " << cp.done.size() << " completed directories\n";
+	}
+	cp.os.exceptions(osExceptions);
+	cp.os.open(checkpointName, ios_base::binary | ios_base::trunc);
+	cp.pending = header;
+	for (auto const & rec : cp.done) {
+		cp.pending += leafRecord(rec);
+	}
+	flushCheckpoint(cp);
+	ActiveCheckpoint = &cp;
+	std::vector<ManifestEntry> manifest;
+	Manifest = Options.manifest ? &manifest : nullptr;
+	std::vector<std::string> written;
+	Written = Options.evict ? &written : nullptr;
+	try {
+		mkDirRange(depth, ".", "", 'a', dirRangeEnd, nrFiles);
+		mkMainFiles();
+	} catch (...) {
+		ActiveCheckpoint = nullptr;
+		Manifest = nullptr;
+		Written = nullptr;
+		flushCheckpoint(cp);
+		throw;
+	}
+	ActiveCheckpoint = nullptr;
+	Manifest = nullptr;
+	Written = nullptr;
+	if (Options.manifest) {
+		mkManifest(manifest, depth, dirRangeEnd, nrFiles);
+	}
+	if (Options.evict) {
+		// Leave the tree as cold as on a freshly provisioned machine.
+		for (auto const & path : written) {
+			evictFile(path);
+		}
+	}
+	cp.os.close();
+	std::remove(checkpointName);
+}
+
+// Changes the working directory for the lifetime of the object.
+class WorkingDir {
+public:
+	explicit WorkingDir(std::string const & dirLocation) :
+			m_previous(4096)
+	{
+		if (getcwd(m_previous.data(), m_previous.size()) == nullptr
+		    || chdir(dirLocation.c_str()) == -1) {
+			throw std::runtime_error("could not enter " + dirLocation);
+		}
+	}
+	~WorkingDir()
+	{
+		if (chdir(m_previous.data()) == -1) {
+			std::cerr << "could not return to " << m_previous.data() << "\n";
+		}
+	}
+	WorkingDir(WorkingDir const &) = delete;
+	WorkingDir & operator=(WorkingDir const &) = delete;
+private:
+	std::vector<char> m_previous;
+};
+
+int getDepth(int const argc, char *argv[])
+{
+	if (argc > 1) {
+		std::istringstream iss(argv[1]);
+		int depth;
+		if (iss >> depth && depth > 0 && iss.eof()) {
+			return depth;
+		}
+	}
+	int const defaultDepth = 1;
+	std::cerr << "Using default depth of " << defaultDepth << "\n";
+	return defaultDepth;
+}
+
+char getDirRangeEnd(int const argc, char *argv[])
+{
+	if (argc > 2) {
+		std::istringstream iss(argv[2]);
+		char theEnd;
+		if (iss >> theEnd && 'a' <= theEnd && theEnd <= 'z') {
+			return theEnd;
+		}
+	}
+	char const defaultEnd = 'a';
+	std::cerr << "Using default range of 'a'..'" << defaultEnd << "'\n";
+	return defaultEnd;
+}
+
+int getFilesPerDir(int const argc, char *argv[])
+{
+	if (argc > 3) {
+		std::istringstream iss(argv[3]);
+		int nrFiles;
+		if (iss >> nrFiles && nrFiles > 0 && iss.eof()) {
+			return nrFiles;
+		}
+	}
+	std::cerr << "Using default of " << defaultFilesPerDir << " files per directory\n";
+	return defaultFilesPerDir;
+}
+
+double runTimed(std::string const & cmd)
+{
+	auto const start = std::chrono::steady_clock::now();
+	if (std::system(cmd.c_str()) != 0) {
+		throw std::runtime_error("`" + cmd + "' failed");
+	}
+	std::chrono::duration<double> const elapsed { std::chrono::steady_clock::now() - start };
+	return elapsed.count();
+}
+
+// Best of a few runs, to keep scheduler noise out of the cost model.
+double runTimedMin(std::string const & cmd, int const runs)
+{
+	double best { runTimed(cmd) };
+	for (int i { 1 }; i < runs; ++i) {
+		best = std::min(best, runTimed(cmd));
+	}
+	return best;
+}
+
+int rmTreeEntry(char const * path, struct stat const *, int, struct FTW *)
+{
+	return remove(path);
+}
+
+void rmTree(std::string const & dirLocation)
+{
+	if (nftw(dirLocation.c_str(), rmTreeEntry, 16, FTW_DEPTH | FTW_PHYS) == -1) {
+		auto const e = errno;
+		std::ostringstream oss;
+		oss << "`nftw(\"" << dirLocation << "\")' failed with errno " << e;
+		throw std::runtime_error(oss.str());
+	}
+}
+
+// A fresh directory from mkdtemp, removed with its contents when the object
+// goes out of scope, also when leaving by an exception.
+class TempDir {
+public:
+	explicit TempDir(std::string tmpl) :
+			m_path(std::move(tmpl))
+	{
+		if (mkdtemp(&m_path[0]) == nullptr) {
+			throw std::runtime_error("`mkdtemp' failed for " + m_path);
+		}
+	}
+	~TempDir()
+	{
+		try {
+			rmTree(m_path);
+		} catch (std::exception const & e) {
+			std::cerr << e.what() << "\n";
+		}
+	}
+	TempDir(TempDir const &) = delete;
+	TempDir & operator=(TempDir const &) = delete;
+	std::string const & path() const { return m_path; }
+private:
+	std::string m_path;
+};
+
+// Measured build cost of this machine and compiler for the code profile
+// emitted by mkheader/mksources.  A TU including k headers costs
+// tuFixed + tuPerInclude * k seconds, an archive of m members costs
+// arFixed + arPerMember * m seconds.
+struct CostModel {
+	double tuFixed;
+	double tuPerInclude;
+	double arFixed;
+	double arPerMember;
+};
+
+struct BuildShape {
+	int depth;
+	int range;
+	int nrFiles;
+};
+
+double nrModules(BuildShape const & shape)
+{
+	return std::pow(static_cast<double>(shape.range), shape.depth);
+}
+
+double nrTUs(BuildShape const & shape)
+{
+	return nrModules(shape) * shape.nrFiles;
+}
+
+// Every TU includes the headers of all files generated before it plus its
+// own, so the N:th TU of the whole tree includes N headers.
+double predictBuildTime(CostModel const & cm, BuildShape const & shape, int const jobs)
+{
+	double const tus { nrTUs(shape) };
+	double const compile { tus * cm.tuFixed + cm.tuPerInclude * tus * (tus + 1) / 2 };
+	double const archive { cm.arFixed + cm.arPerMember * shape.nrFiles };
+	double const total { compile + nrModules(shape) * archive };
+	double const criticalPath { cm.tuFixed + cm.tuPerInclude * tus + archive };
+	return std::max(total / jobs, criticalPath);
+}
+
+// Fits the cost model against the calibration sample in the current directory.
+CostModel measureSample(std::string const & cxx, int const sampleFiles, int const sampleStride)
+{
+	// Least squares fit of compile time against number of includes.
+	double sx { }, sy { }, sxx { }, sxy { };
+	int n { };
+	std::string objects;
+	for (int i { }; i < sampleFiles; i += sampleStride) {
+		std::string const fname { "directory_a/" + baseFilename("a", i) };
+		double const k { i + 1.0 };
+		double const t { runTimedMin(cxx + " -std=c++11 -c " + fname + srcExt + " -o " + fname + ".o", 2) };
+		std::cerr << "  TU with " << k << " includes: " << t << " s\n";
+		sx += k;
+		sy += t;
+		sxx += k * k;
+		sxy += k * t;
+		++n;
+		objects += " " + fname + ".o";
+	}
+	CostModel cm { };
+	cm.tuPerInclude = std::max(0.0, (n * sxy - sx * sy) / (n * sxx - sx * sx));
+	cm.tuFixed = std::max(0.0, (sy - cm.tuPerInclude * sx) / n);
+
+	std::string const firstObject { objects.substr(0, objects.find(' ', 1)) };
+	double const arOne { runTimedMin("ar cr directory_a/one.a" + firstObject, 3) };
+	double const arAll { runTimedMin("ar cr directory_a/all.a" + objects, 3) };
+	cm.arPerMember = std::max(0.0, (arAll - arOne) / (n - 1));
+	cm.arFixed = std::max(0.0, arOne - cm.arPerMember);
+	return cm;
+}
+
+CostModel measureCostModel()
+{
+	char const * const envCxx = std::getenv("CXX");
+	std::string const cxx { envCxx != nullptr && *envCxx != '\0' ? envCxx : "c++" };
+	int const sampleFiles { 400 };
+
+	TempDir const tmp { "/tmp/bigprojgen-calibrate-XXXXXX" };
+	WorkingDir const wd { tmp.path() };
+	std::cerr << "Generating calibration sample in " << tmp.path() << "\n";
+	generate(1, 'a', sampleFiles, false);
+	return measureSample(cxx, sampleFiles, 50);
+}
+
+// Counts parse as int, so "2.5" is rejected rather than truncated.
+template<typename T>
+bool parsePositive(char const * arg, T & value)
+{
+	std::istringstream iss(arg);
+	return iss >> value && value > 0 && iss.eof();
+}
+
+template<typename T>
+bool parseNonNegative(char const * arg, T & value)
+{
+	std::istringstream iss(arg);
+	return iss >> value && value >= 0 && iss.eof();
+}
+
+// The shape arguments argv[1] .. argv[3] like getDepth, getDirRangeEnd and
+// getFilesPerDir, defaulted when left out, but false when one is given and
+// does not parse: a mistyped shape must not silently become another one.
+bool parseShape(int const argc, char *argv[], int & depth, char & dirRangeEnd, int & nrFiles)
+{
+	depth = 1;
+	dirRangeEnd = 'a';
+	nrFiles = defaultFilesPerDir;
+	if (argc > 1 && !parsePositive(argv[1], depth)) {
+		return false;
+	}
+	if (argc > 2) {
+		if (std::strlen(argv[2]) != 1 || argv[2][0] < 'a' || 'z' < argv[2][0]) {
+			return false;
+		}
+		dirRangeEnd = argv[2][0];
+	}
+	return argc <= 3 || parsePositive(argv[3], nrFiles);
+}
+
+// calibrate <target-build-seconds> <target-TUs> [jobs]
+int calibrate(int const argc, char *argv[])
+{
+	double targetSeconds { }, targetTUs { };
+	int jobs { 1 };
+	if (argc < 3 || !parsePositive(argv[1], targetSeconds) || !parsePositive(argv[2], targetTUs)
+	    || (argc > 3 && !parsePositive(argv[3], jobs))) {
+		std::cerr << "usage: bigprojgen calibrate <target-build-seconds> <target-TUs> [jobs]\n";
+		return EXIT_FAILURE;
+	}
+	// Caught here so the sample directory is unwound and removed.
+	CostModel cm { };
+	try {
+		cm = measureCostModel();
+	} catch (std::exception const & e) {
+		std::cerr << "calibration failed: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	std::cerr << "Cost model: TU " << cm.tuFixed << " s + " << cm.tuPerInclude
+	          << " s/include, archive " << cm.arFixed << " s + " << cm.arPerMember << " s/member\n";
+
+	BuildShape best { 1, 1, 1 };
+	double bestScore { std::numeric_limits<double>::max() };
+	for (int depth { 1 }; depth <= 4; ++depth) {
+		for (int range { 1 }; range <= 'z' - 'a' + 1; ++range) {
+			for (int nrFiles { 1 }; nrFiles <= 999; ++nrFiles) {
+				BuildShape const shape { depth, range, nrFiles };
+				double const t { predictBuildTime(cm, shape, jobs) };
+				double const score { std::fabs(std::log(t / targetSeconds))
+				                     + std::fabs(std::log(nrTUs(shape) / targetTUs)) };
+				if (score < bestScore) {
+					bestScore = score;
+					best = shape;
+				}
+			}
+		}
+	}
+	std::cerr << "Predicted: " << nrTUs(best) << " TUs in " << nrModules(best)
+	          << " modules, build time " << predictBuildTime(cm, best, jobs)
+	          << " s at -j" << jobs << "\n";
+	std::cout << "bigprojgen " << best.depth << " " << static_cast<char>('a' + best.range - 1)
+	          << " " << best.nrFiles << "\n";
+	return EXIT_SUCCESS;
+}
+
+// --emit=<flavour>[,<flavour>...] with flavours cmake, recursive,
+// nonharmful, jb or all.
+unsigned parseEmit(std::string const & list)
+{
+	std::pair<char const *, unsigned> const flavours[] {
+		{ "cmake", EmitCMake },
+		{ "recursive", EmitRecursive },
+		{ "nonharmful", EmitNonHarmful },
+		{ "jb", EmitJb },
+		{ "all", EmitCMake | EmitRecursive | EmitNonHarmful | EmitJb },
+	};
+	unsigned emit { };
+	std::istringstream iss(list);
+	std::string name;
+	while (std::getline(iss, name, ',')) {
+		auto const f = std::find_if(std::begin(flavours), std::end(flavours),
+		                [&name](std::pair<char const *, unsigned> const & fl) { return name == fl.first; });
+		if (f == std::end(flavours)) {
+			throw std::runtime_error("unknown --emit flavour " + name);
+		}
+		emit |= f->second;
+	}
+	if (emit == 0) {
+		throw std::runtime_error("--emit needs at least one flavour");
+	}
+	return emit;
+}
+
+// The headers and sources of one shape, as recorded while generating it.
+struct CachedShape {
+	std::vector<OutputEntry> entries;
+	std::size_t bytes;
+	std::uint64_t lastUse;
+};
+
+// What `serve' keeps resident between requests: the headers and sources of
+// the shapes generated most recently, within a bound on their total size, and the shape
+// each output directory was populated with, by canonical path.
+struct ServeState {
+	std::map<std::string, CachedShape> shapes;
+	std::map<std::string, std::string> outdirs;
+	std::size_t cacheBytes;
+	std::size_t cacheLimit;
+	std::uint64_t uses;
+	int mutations;
+};
+
+// Drops the least recently used shapes until the cache is within its bound.
+void evictShapes(ServeState & state)
+{
+	while (state.cacheBytes > state.cacheLimit) {
+		auto const lru = std::min_element(state.shapes.begin(), state.shapes.end(),
+		                [](std::pair<std::string const, CachedShape> const & a,
+		                   std::pair<std::string const, CachedShape> const & b) {
+		                        return a.second.lastUse < b.second.lastUse;
+		                });
+		state.cacheBytes -= lru->second.bytes;
+		state.shapes.erase(lru);
+	}
+}
+
+// Absolute path of an existing directory, symbolic links resolved.
+std::string canonicalPath(std::string const & path)
+{
+	char * const resolved { realpath(path.c_str(), nullptr) };
+	if (resolved == nullptr) {
+		throw std::runtime_error("no such directory " + path);
+	}
+	std::string const canonical { resolved };
+	std::free(resolved);
+	return canonical;
+}
+
+// The generated directory <outdir> refers to, however it is spelled.
+std::map<std::string, std::string>::iterator servedOutdir(ServeState & state, std::string const & outdir)
+{
+	std::string canonical;
+	try {
+		canonical = canonicalPath(outdir);
+	} catch (std::runtime_error const &) {
+	}
+	auto const served = state.outdirs.find(canonical);
+	if (served == state.outdirs.end()) {
+		throw std::runtime_error(outdir + " was not generated by this server");
+	}
+	return served;
+}
+
+std::string serveGenerate(ServeState & state, std::istream & args)
+{
+	std::string outdir, flavours;
+	int depth { }, nrFiles { };
+	char dirRangeEnd { };
+	if (!(args >> outdir >> depth >> dirRangeEnd >> nrFiles) || depth <= 0
+	    || dirRangeEnd < 'a' || 'z' < dirRangeEnd || nrFiles <= 0) {
+		throw std::runtime_error("usage: generate <outdir> <depth> <range-end> <files-per-directory> [flavours]");
+	}
+	unsigned const emit { args >> flavours ? parseEmit(flavours) : Options.emit };
+	std::ostringstream key;
+	key << depth << ' ' << dirRangeEnd << ' ' << nrFiles;
+	mkDir(outdir);
+	WorkingDir const wd { outdir };
+	state.outdirs[canonicalPath(".")] = key.str();
+	// Directories, build descriptions, main files, the manifest and eviction
+	// always come from generate; only headers and sources are cached.
+	auto const cached = state.shapes.find(key.str());
+	std::vector<OutputEntry> entries;
+	Replay replay { cached != state.shapes.end() ? &cached->second.entries : nullptr, 0 };
+	auto const savedEmit = Options.emit;
+	Options.emit = emit;
+	if (replay.entries != nullptr) {
+		Replaying = &replay;
+	} else {
+		Recording = &entries;
+	}
+	try {
+		generate(depth, dirRangeEnd, nrFiles, false);
+	} catch (...) {
+		Replaying = nullptr;
+		Recording = nullptr;
+		Options.emit = savedEmit;
+		throw;
+	}
+	Replaying = nullptr;
+	Recording = nullptr;
+	Options.emit = savedEmit;
+	if (replay.entries != nullptr) {
+		cached->second.lastUse = ++state.uses;
+		return "cached " + std::to_string(replay.next) + " sources";
+	}
+	auto const nrEntries = entries.size();
+	std::size_t bytes { };
+	for (auto const & entry : entries) {
+		bytes += sizeof entry + entry.path.capacity() + entry.content.capacity();
+	}
+	if (bytes > state.cacheLimit) {
+		return "generated " + std::to_string(nrEntries) + " sources, too large to cache";
+	}
+	state.shapes[key.str()] = CachedShape { std::move(entries), bytes, ++state.uses };
+	state.cacheBytes += bytes;
+	evictShapes(state);
+	return "generated " + std::to_string(nrEntries) + " sources";
+}
+
+// Rewrites the first <count> sources of <outdir>, in generation order, with
+// a trailing comment so that they are out of date for an incremental build.
+// The comment of an earlier mutation is replaced, not added to.
+std::string serveMutate(ServeState & state, std::istream & args)
+{
+	std::string outdir;
+	int count { };
+	if (!(args >> outdir >> count) || count < 0) {
+		throw std::runtime_error("usage: mutate <outdir> <count>");
+	}
+	auto const served = servedOutdir(state, outdir);
+	std::istringstream shape(served->second);
+	int depth { }, nrFiles { };
+	char dirRangeEnd { };
+	shape >> depth >> dirRangeEnd >> nrFiles;
+	std::string const markPrefix { "// mutation " };
+	std::string const mark { markPrefix + std::to_string(++state.mutations) + "\n" };
+	std::vector<std::string> leaves;
+	leafNamebases(depth, "", 'a', dirRangeEnd, leaves);
+	int mutated { };
+	for (auto const & namebase : leaves) {
+		for (int i { }; i != nrFiles && mutated != count; ++i, ++mutated) {
+			std::string const path { served->first + "/" + moduleDir(namebase) + "/"
+			                         + baseFilename(namebase, i) + srcExt };
+			std::ifstream ifs(path);
+			if (!ifs) {
+				throw std::runtime_error("could not read " + path);
+			}
+			std::ostringstream oss;
+			oss << ifs.rdbuf();
+			std::string content { oss.str() };
+			auto const last = content.rfind('\n', content.length() < 2 ? 0 : content.length() - 2);
+			if (last != std::string::npos && content.compare(last + 1, markPrefix.length(), markPrefix) == 0) {
+				content.resize(last + 1);
+			}
+			mkFileWithContent(path, content + mark);
+		}
+	}
+	return "mutated " + std::to_string(mutated) + " sources";
+}
+
+std::string serveClean(ServeState & state, std::istream & args)
+{
+	std::string outdir;
+	if (!(args >> outdir)) {
+		throw std::runtime_error("usage: clean <outdir>");
+	}
+	auto const served = servedOutdir(state, outdir);
+	rmTree(served->first);
+	state.outdirs.erase(served);
+	return "removed " + outdir;
+}
+
+// Handles one request line; returns false when the server should stop.
+bool serveRequest(ServeState & state, std::string const & line, std::string & reply)
+{
+	std::istringstream iss(line);
+	std::string cmd;
+	iss >> cmd;
+	auto const start = std::chrono::steady_clock::now();
+	try {
+		std::string result;
+		if (cmd == "generate") {
+			result = serveGenerate(state, iss);
+		} else if (cmd == "mutate") {
+			result = serveMutate(state, iss);
+		} else if (cmd == "clean") {
+			result = serveClean(state, iss);
+		} else if (cmd == "quit") {
+			reply = "ok bye\n";
+			return false;
+		} else {
+			throw std::runtime_error("unknown request `" + cmd + "'");
+		}
+		std::chrono::duration<double> const elapsed { std::chrono::steady_clock::now() - start };
+		std::ostringstream oss;
+		oss << "ok " << result << " in " << elapsed.count() << " s\n";
+		reply = oss.str();
+	} catch (std::exception const & e) {
+		reply = std::string("error ") + e.what() + "\n";
+	}
+	return true;
+}
+
+sockaddr_un socketAddress(std::string const & socketPath)
+{
+	sockaddr_un addr { };
+	if (socketPath.length() >= sizeof addr.sun_path) {
+		throw std::runtime_error("socket path too long: " + socketPath);
+	}
+	addr.sun_family = AF_UNIX;
+	std::strcpy(addr.sun_path, socketPath.c_str());
+	return addr;
+}
+
+void writeAll(int const fd, std::string const & data)
+{
+	std::size_t done { };
+	while (done < data.length()) {
+		// MSG_NOSIGNAL: a peer that has gone away is an error, not SIGPIPE.
+		auto const n = send(fd, data.data() + done, data.length() - done, MSG_NOSIGNAL);
+		if (n == -1 && errno != EINTR) {
+			auto const e = errno;
+			throw std::runtime_error("write to socket failed with errno " + std::to_string(e));
+		}
+		done += n == -1 ? 0 : n;
+	}
+}
+
+// Serves the requests of one connection; returns false after `quit'.
+bool serveConnection(ServeState & state, int const conn)
+{
+	bool running { true };
+	std::string pending;
+	char buf[4096];
+	ssize_t n;
+	while (running && ((n = read(conn, buf, sizeof buf)) > 0 || (n == -1 && errno == EINTR))) {
+		pending.append(buf, n == -1 ? 0 : n);
+		std::string::size_type eol;
+		while (running && (eol = pending.find('\n')) != std::string::npos) {
+			std::string reply;
+			running = serveRequest(state, pending.substr(0, eol), reply);
+			pending.erase(0, eol + 1);
+			writeAll(conn, reply);
+		}
+	}
+	return running;
+}
+
+// serve <socket-path> [cache-megabytes]
+//
+// Accepts newline separated requests on a Unix domain socket:
+//   generate <outdir> <depth> <range-end> <files-per-directory> [flavours]
+//   mutate <outdir> <count>
+//   clean <outdir>
+//   quit
+// Relative paths are taken relative to the directory the server started in.
+// The output of the most recently used shapes is cached up to
+// cache-megabytes, default 1024.
+int serve(int const argc, char *argv[])
+{
+	int cacheMegabytes { 1024 };
+	if (argc < 2 || argc > 3 || (argc == 3 && !parsePositive(argv[2], cacheMegabytes))) {
+		std::cerr << "usage: bigprojgen serve <socket-path> [cache-megabytes]\n";
+		return EXIT_FAILURE;
+	}
+	auto const addr = socketAddress(argv[1]);
+	struct stat st;
+	if (stat(argv[1], &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(argv[1]);
+	}
+	int const listener { socket(AF_UNIX, SOCK_STREAM, 0) };
+	if (listener == -1
+	    || bind(listener, reinterpret_cast<sockaddr const *>(&addr), sizeof addr) == -1
+	    || listen(listener, 16) == -1) {
+		auto const e = errno;
+		std::ostringstream oss;
+		oss << "could not listen on " << argv[1] << ", errno " << e;
+		throw std::runtime_error(oss.str());
+	}
+	ServeState state { };
+	state.cacheLimit = static_cast<std::size_t>(cacheMegabytes) << 20;
+	bool running { true };
+	while (running) {
+		int const conn { accept(listener, nullptr, nullptr) };
+		if (conn == -1) {
+			if (errno != EINTR) {
+				std::cerr << "accept failed with errno " << errno << "\n";
+			}
+			continue;
+		}
+		// A failing connection is dropped, the server and its cache stay.
+		try {
+			running = serveConnection(state, conn);
+		} catch (std::exception const & e) {
+			std::cerr << "connection dropped: " << e.what() << "\n";
+		}
+		close(conn);
+	}
+	close(listener);
+	unlink(argv[1]);
+	return EXIT_SUCCESS;
+}
+
+// request <socket-path> <request words...>
+int request(int const argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cerr << "usage: bigprojgen request <socket-path> <request...>\n";
+		return EXIT_FAILURE;
+	}
+	auto const addr = socketAddress(argv[1]);
+	int const fd { socket(AF_UNIX, SOCK_STREAM, 0) };
+	if (fd == -1 || connect(fd, reinterpret_cast<sockaddr const *>(&addr), sizeof addr) == -1) {
+		throw std::runtime_error(std::string("could not connect to ") + argv[1]);
+	}
+	std::string line { argv[2] };
+	for (int i { 3 }; i < argc; ++i) {
+		line += ' ';
+		line += argv[i];
+	}
+	writeAll(fd, line + "\n");
+	shutdown(fd, SHUT_WR);
+	std::string reply;
+	char buf[4096];
+	ssize_t n;
+	while ((n = read(fd, buf, sizeof buf)) > 0) {
+		reply.append(buf, n);
+	}
+	close(fd);
+	std::cout << reply;
+	return reply.compare(0, 3, "ok ") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// cachefamily <members> <comment-percent> <semantic-percent> [depth] [range-end] [files]
+//
+// Writes member_0 .. member_<members-1>, trees that differ only in their
+// sources.  In every member after the first, exactly the given percentages
+// of the TUs get a comment only or a semantic change against member_0, the
+// rest are byte identical to it.
+int cacheFamily(int const argc, char *argv[])
+{
+	int members { }, depth { }, nrFiles { };
+	char dirRangeEnd { };
+	double commentPercent { }, semanticPercent { };
+	if (argc < 4 || argc > 7 || !parsePositive(argv[1], members) || !parseNonNegative(argv[2], commentPercent)
+	    || !parseNonNegative(argv[3], semanticPercent) || commentPercent + semanticPercent > 100
+	    || !parseShape(argc - 3, argv + 3, depth, dirRangeEnd, nrFiles)) {
+		std::cerr << "usage: bigprojgen cachefamily <members> <comment-percent> <semantic-percent>"
+		             " [depth] [range-end] [files]\n";
+		return EXIT_FAILURE;
+	}
+	auto const tus = static_cast<std::size_t>(nrTUs(BuildShape { depth, dirRangeEnd - 'a' + 1, nrFiles }));
+	auto const nrComment = static_cast<std::size_t>(std::lround(tus * commentPercent / 100));
+	auto const nrSemantic = static_cast<std::size_t>(std::lround(tus * semanticPercent / 100));
+
+	std::vector<std::size_t> order(tus);
+	for (std::size_t i { }; i != tus; ++i) {
+		order[i] = i;
+	}
+	for (int member { }; member < members; ++member) {
+		SourceChanges.assign(tus, Identical);
+		SourceRevision = member;
+		if (member != 0) {
+			std::default_random_engine shuffler { static_cast<unsigned>(member) };
+			std::shuffle(order.begin(), order.end(), shuffler);
+			for (std::size_t i { }; i != nrComment + nrSemantic; ++i) {
+				SourceChanges[order[i]] = i < nrComment ? CommentOnly : Semantic;
+			}
+		}
+		std::string const dir { "member_" + std::to_string(member) };
+		mkDir(dir);
+		{
+			WorkingDir const wd { dir };
+			generate(depth, dirRangeEnd, nrFiles, false);
+		}
+		if (member != 0) {
+			std::cout << dir << ": " << tus - nrComment - nrSemantic << " identical, "
+			          << nrComment << " comment only, " << nrSemantic << " semantic of " << tus
+			          << " TUs; expected hit ratio direct mode "
+			          << 100.0 * (tus - nrComment - nrSemantic) / tus << "%, preprocessor mode "
+			          << 100.0 * (tus - nrSemantic) / tus << "%\n";
+		}
+	}
+	SourceChanges.clear();
+	return EXIT_SUCCESS;
+}
+
+// Reads a manifest written by --manifest: the files, the directory hashes
+// and a description of the generation parameters.
+std::vector<ManifestEntry> readManifest(std::string const & manifestPath,
+                std::map<std::string, std::string> & dirs, std::string & parameters)
+{
+	std::ifstream ifs(manifestPath);
+	std::string line;
+	if (!std::getline(ifs, line) || line != manifestMagic) {
+		throw std::runtime_error(manifestPath + " is not a bigprojgen manifest");
+	}
+	std::vector<ManifestEntry> files;
+	while (std::getline(ifs, line)) {
+		std::istringstream iss(line);
+		std::string kind, hash, path;
+		ManifestEntry entry { };
+		iss >> kind;
+		if (kind == "P") {
+			int depth, nrFiles;
+			char dirRangeEnd;
+			unsigned emit;
+			iss >> depth >> dirRangeEnd >> nrFiles >> emit;
+			std::ostringstream oss;
+			oss << "depth " << depth << ", range a.." << dirRangeEnd << ", "
+			    << nrFiles << " files per directory, emit flags " << emit;
+			parameters = oss.str();
+		} else if (kind == "F" && iss >> hash >> entry.size >> entry.path) {
+			entry.hash = std::stoull(hash, nullptr, 16);
+			files.push_back(entry);
+		} else if (kind == "D" && iss >> hash >> path) {
+			dirs[path] = hash;
+		} else {
+			throw std::runtime_error("bad manifest line: " + line);
+		}
+	}
+	return files;
+}
+
+// Hashes the files below top on a pool of threads; readable tells which
+// files could be read at all.
+std::vector<ManifestEntry> hashFilesParallel(std::string const & top, std::vector<ManifestEntry> const & files,
+                int const threads, std::vector<char> & readable)
+{
+	std::vector<ManifestEntry> actual(files.size());
+	readable.assign(files.size(), 0);
+	std::atomic<std::size_t> next { 0 };
+	auto const worker = [&] {
+		for (std::size_t i; (i = next++) < files.size(); ) {
+			actual[i].path = files[i].path;
+			readable[i] = hashFile(top + "/" + files[i].path, actual[i].hash, actual[i].size);
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int t { }; t < threads; ++t) {
+		pool.emplace_back(worker);
+	}
+	for (auto & t : pool) {
+		t.join();
+	}
+	return actual;
+}
+
+// verify [manifest] [threads]
+//
+// Re-hashes the files listed in a manifest written by --manifest, relative to
+// the directory of the manifest, and reports the files and the smallest
+// directories that differ.  Files added after generation are not noticed.
+int verify(int const argc, char *argv[])
+{
+	std::string const manifestPath { argc > 1 ? argv[1] : manifestName };
+	int threads { static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+	if (argc > 2 && !parsePositive(argv[2], threads)) {
+		std::cerr << "usage: bigprojgen verify [manifest] [threads]\n";
+		return EXIT_FAILURE;
+	}
+	std::map<std::string, std::string> expectedDirs;
+	std::string parameters;
+	auto const expected = readManifest(manifestPath, expectedDirs, parameters);
+	std::cout << "Parameters: " << parameters << "\n";
+	auto const slash = manifestPath.rfind('/');
+	std::string const top { slash == std::string::npos ? "." : manifestPath.substr(0, slash) };
+	std::vector<char> readable;
+	auto const actual = hashFilesParallel(top, expected, threads, readable);
+
+	std::size_t differing { };
+	for (std::size_t i { }; i != expected.size(); ++i) {
+		if (!readable[i] || actual[i].hash != expected[i].hash || actual[i].size != expected[i].size) {
+			if (++differing <= 20) {
+				std::cout << (readable[i] ? "differs: " : "missing: ") << expected[i].path << "\n";
+			}
+		}
+	}
+	auto const actualDirs = treeHashes(actual);
+	std::vector<std::string> badDirs;
+	for (auto const & d : expectedDirs) {
+		auto const a = actualDirs.find(d.first);
+		if (a == actualDirs.end() || hexHash(a->second) != d.second) {
+			badDirs.push_back(d.first);
+		}
+	}
+	// Report only the deepest differing directories; their ancestors differ
+	// because of them.
+	for (auto const & dir : badDirs) {
+		std::string const prefix { dir == "." ? "" : dir + "/" };
+		bool const hasBadChild = std::any_of(badDirs.begin(), badDirs.end(), [&](std::string const & d) {
+			return d != dir && d != "." && d.compare(0, prefix.length(), prefix) == 0;
+		});
+		if (!hasBadChild) {
+			std::cout << "differing subtree: " << dir << "\n";
+		}
+	}
+	std::cout << expected.size() << " files, " << differing << " differing, "
+	          << (badDirs.empty() ? "tree intact" : "tree differs") << "\n";
+	return badDirs.empty() && differing == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// One compile or archive step of a build, joined to the generated file.
+struct BuildStep {
+	std::string what;
+	double start;
+	double end;
+	bool timed;
+};
+
+// What the generator knows about a generated TU or archive.
+struct GraphNode {
+	std::string module;
+	int leaf;
+	int includes;
+	bool isArchive;
+};
+
+// The generated file name in a build log line: a file_<namebase>_<nr> TU or
+// a lib<namebase>core archive.  Empty if there is none.
+std::string generatedName(std::string const & text)
+{
+	std::string const archive { std::string(libNamePostfix) + libExt };
+	auto pos = text.find(archive);
+	auto const lib = pos == std::string::npos ? pos : text.rfind("lib", pos);
+	if (lib != std::string::npos) {
+		return text.substr(lib, pos + sizeof libNamePostfix - 1 - lib);
+	}
+	pos = text.rfind("file_");
+	if (pos != std::string::npos) {
+		auto end = text.find('_', pos + filePrefixLen);
+		if (end != std::string::npos) {
+			end = text.find_first_not_of("0123456789", end + 1);
+			return text.substr(pos, end == std::string::npos ? end : end - pos);
+		}
+	}
+	return std::string();
+}
 
-int GetCurrentYear()
+// .ninja_log: start and end in ms, mtime, output, command hash.
+void readNinjaLog(std::istream & is, std::vector<BuildStep> & steps)
 {
-	static int currentYear { };
-	if (currentYear == 0) {
-		using std::chrono::system_clock;
-		auto const now = system_clock::now();
-		auto const tt = system_clock::to_time_t(now);
-		struct std::tm tp;
-		if (localtime_r(&tt, &tp) == nullptr) {
-			throw std::runtime_error("problem with localtime_r");
+	std::map<std::string, BuildStep> last;
+	std::string line;
+	while (std::getline(is, line)) {
+		std::istringstream iss(line);
+		double start, end;
+		std::string mtime, output;
+		if (line.empty() || line[0] == '#' || !(iss >> start >> end >> mtime >> output)) {
+			continue;
 		}
-		currentYear = tp.tm_year + 1900;
+		last[output] = BuildStep { output, start / 1000, end / 1000, true };
+	}
+	for (auto const & l : last) {
+		steps.push_back(l.second);
 	}
-	return currentYear;
 }
 
-int RandInt(int low, int high)
+// Make timing log: `<start> <end> <command>' per recipe line, in seconds.
+void readMakeTiming(std::istream & is, std::vector<BuildStep> & steps)
 {
-	static std::default_random_engine re { };
-	using Dist = std::uniform_int_distribution<int>;
-	static Dist uid { };
-	return uid(re, Dist::param_type { low, high });
+	std::string line;
+	while (std::getline(is, line)) {
+		std::istringstream iss(line);
+		double start, end;
+		if (iss >> start >> end) {
+			steps.push_back(BuildStep { line, start, end, true });
+		}
+	}
 }
 
-std::string mkIncludeGuard(std::string const & fname)
+// The dur of the first trace event called name, in seconds, or -1.
+double traceEventSeconds(std::string const & json, std::string const & name)
 {
-	std::string incguard{fname};
-	for (auto & c : incguard) {
-		c = std::toupper(c);
+	auto const at = json.find("\"name\":\"" + name + "\"");
+	if (at == std::string::npos) {
+		return -1;
 	}
-	incguard += "_H_";
-	for (int i = 0; i < 10; ++i) {
-		auto const c = RandInt(0, 9 + (('Z' - 'A') + 1));
-		if (c < 10) {
-			incguard += '0' + c;
+	auto const begin = json.rfind('{', at);
+	auto const dur = json.find("\"dur\":", begin);
+	if (dur == std::string::npos || dur > json.find('}', at)) {
+		return -1;
+	}
+	return std::strtod(json.c_str() + dur + 6, nullptr) / 1e6;
+}
+
+// -ftime-trace JSON of one TU: durations only, no position in the build.
+void readTimeTrace(std::string const & path, std::string const & json, std::vector<BuildStep> & steps,
+                   std::map<std::string, double> & frontend)
+{
+	double const total { traceEventSeconds(json, "Total ExecuteCompiler") };
+	if (total < 0) {
+		throw std::runtime_error(path + " has no `Total ExecuteCompiler' event");
+	}
+	auto const name = generatedName(path);
+	steps.push_back(BuildStep { path, 0, total, false });
+	double const front { traceEventSeconds(json, "Total Frontend") };
+	if (front >= 0) {
+		frontend[name] = front;
+	}
+}
+
+// ingest <depth> <range-end> <files> <log>...
+//
+// Joins .ninja_log, make timing logs and -ftime-trace JSON of a build of
+// the tree generated with the given arguments to the generated graph, and
+// reports hot spots, critical path and core utilisation.
+int ingest(int const argc, char *argv[])
+{
+	// No defaults here: logs joined to the wrong graph would still report.
+	int depth { }, nrFiles { };
+	char dirRangeEnd { };
+	if (argc < 5 || !parseShape(4, argv, depth, dirRangeEnd, nrFiles)) {
+		std::cerr << "usage: bigprojgen ingest <depth> <range-end> <files-per-directory> <log>...\n";
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> leaves;
+	leafNamebases(depth, "", 'a', dirRangeEnd, leaves);
+	std::map<std::string, GraphNode> graph;
+	for (std::size_t leaf { }; leaf != leaves.size(); ++leaf) {
+		for (int i { }; i != nrFiles; ++i) {
+			int const tu { static_cast<int>(leaf) * nrFiles + i };
+			graph[baseFilename(leaves[leaf], i)] = GraphNode { leaves[leaf], static_cast<int>(leaf), tu + 1, false };
+		}
+		graph["lib" + leaves[leaf] + libNamePostfix] = GraphNode { leaves[leaf], static_cast<int>(leaf), 0, true };
+	}
+
+	std::vector<BuildStep> steps;
+	std::map<std::string, double> frontend;
+	for (int i { 4 }; i < argc; ++i) {
+		std::ifstream ifs(argv[i]);
+		if (!ifs) {
+			throw std::runtime_error(std::string("could not read ") + argv[i]);
+		}
+		std::ostringstream oss;
+		oss << ifs.rdbuf();
+		std::string const text { oss.str() };
+		std::istringstream iss(text);
+		if (text.compare(0, 12, "# ninja log ") == 0) {
+			readNinjaLog(iss, steps);
+		} else if (text.find("\"traceEvents\"") != std::string::npos) {
+			readTimeTrace(argv[i], text, steps, frontend);
 		} else {
-			incguard += 'A' + c - 10;
+			readMakeTiming(iss, steps);
 		}
 	}
-	incguard += "_INCLUDED_";
-	return incguard;
+
+	// Per generated file the longest step, which is the compile or archive
+	// rather than a dependency scan or echo.  Steps with a place in the
+	// build's timeline win over trace durations.
+	std::map<std::string, BuildStep> byName;
+	std::size_t unmatched { };
+	double firstStart { std::numeric_limits<double>::max() }, lastEnd { };
+	for (auto const & step : steps) {
+		auto const name = generatedName(step.what);
+		if (graph.count(name) == 0) {
+			++unmatched;
+			continue;
+		}
+		auto & known = byName[name];
+		if (known.what.empty() || (step.timed && !known.timed)
+		    || (step.timed == known.timed && step.end - step.start > known.end - known.start)) {
+			known = step;
+		}
+		if (step.timed) {
+			firstStart = std::min(firstStart, step.start);
+			lastEnd = std::max(lastEnd, step.end);
+		}
+	}
+	if (byName.empty()) {
+		std::cerr << "no build step matches the generated tree\n";
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::pair<double, std::string>> tus;
+	std::map<std::string, double> moduleTime, moduleLongestTU, moduleArchive;
+	double total { };
+	double sx { }, sy { }, sxx { }, sxy { }, syy { };
+	for (auto const & b : byName) {
+		auto const & node = graph[b.first];
+		double const t { b.second.end - b.second.start };
+		total += t;
+		moduleTime[node.module] += t;
+		if (node.isArchive) {
+			moduleArchive[node.module] = t;
+			continue;
+		}
+		tus.emplace_back(t, b.first);
+		moduleLongestTU[node.module] = std::max(moduleLongestTU[node.module], t);
+		sx += node.includes;
+		sy += t;
+		sxx += double(node.includes) * node.includes;
+		sxy += node.includes * t;
+		syy += t * t;
+	}
+	std::sort(tus.rbegin(), tus.rend());
+
+	std::cout << std::fixed << std::setprecision(3)
+	          << byName.size() << " generated TUs and archives matched, " << unmatched
+	          << " other steps ignored, " << total << " s of work\n\n"
+	          << "Slowest TUs:\n";
+	for (std::size_t i { }; i != std::min<std::size_t>(10, tus.size()); ++i) {
+		auto const & node = graph[tus[i].second];
+		std::cout << "  " << tus[i].first << " s  " << tus[i].second << "  module " << moduleDir(node.module)
+		          << " (" << node.leaf + 1 << " of " << leaves.size() << "), " << node.includes << " includes";
+		if (frontend.count(tus[i].second) != 0) {
+			std::cout << ", frontend " << frontend[tus[i].second] << " s";
+		}
+		std::cout << "\n";
+	}
+	std::vector<std::pair<double, std::string>> modules;
+	for (auto const & m : moduleTime) {
+		modules.emplace_back(m.second, m.first);
+	}
+	std::sort(modules.rbegin(), modules.rend());
+	std::cout << "Most expensive modules:\n";
+	for (std::size_t i { }; i != std::min<std::size_t>(5, modules.size()); ++i) {
+		std::cout << "  " << modules[i].first << " s  " << moduleDir(modules[i].second) << "\n";
+	}
+	double const n { static_cast<double>(tus.size()) };
+	if (tus.size() > 1 && n * sxx != sx * sx) {
+		double const slope { (n * sxy - sx * sy) / (n * sxx - sx * sx) };
+		double const r { (n * sxy - sx * sy) / std::sqrt((n * sxx - sx * sx) * (n * syy - sy * sy)) };
+		std::cout << "Include fan-in: " << slope * 1000 << " ms per included header, explains "
+		          << 100 * r * r << "% of the TU time variation\n";
+	}
+
+	if (lastEnd <= firstStart) {
+		std::cout << "No start and end times, skipping critical path and utilisation\n";
+		return EXIT_SUCCESS;
+	}
+	// Utilisation over time in buckets; the build's core count is taken as
+	// its highest concurrency.
+	int const nrBuckets { 20 };
+	double const wall { lastEnd - firstStart };
+	std::vector<double> busy(nrBuckets);
+	std::vector<std::pair<double, int>> edges;
+	for (auto const & b : byName) {
+		auto const & st = b.second;
+		if (!st.timed) {
+			continue;
+		}
+		edges.emplace_back(st.start, 1);
+		edges.emplace_back(st.end, -1);
+		for (int k { }; k != nrBuckets; ++k) {
+			double const lo { firstStart + wall * k / nrBuckets }, hi { firstStart + wall * (k + 1) / nrBuckets };
+			busy[k] += std::max(0.0, std::min(hi, st.end) - std::max(lo, st.start));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	int running { }, cores { 1 };
+	for (auto const & e : edges) {
+		running += e.second;
+		cores = std::max(cores, running);
+	}
+	double longestChain { };
+	for (auto const & m : moduleLongestTU) {
+		longestChain = std::max(longestChain, m.second + moduleArchive[m.first]);
+	}
+	double const ideal { std::max(total / cores, longestChain) };
+	std::cout << "Critical path: achieved " << wall << " s, ideal " << ideal << " s on " << cores
+	          << " cores (work / cores " << total / cores << " s, longest TU plus archive "
+	          << longestChain << " s), " << 100 * ideal / wall << "% efficient\n"
+	          << "Core utilisation over time:\n";
+	for (int k { }; k != nrBuckets; ++k) {
+		double const share { busy[k] / (wall / nrBuckets * cores) };
+		std::cout << "  " << std::setw(8) << wall * k / nrBuckets << " s " << std::setw(6) << 100 * share
+		          << "% " << std::string(static_cast<std::size_t>(share * 40 + 0.5), '#') << "\n";
+	}
+	return EXIT_SUCCESS;
 }
 
-std::string baseFilename(std::string const & namebase, int const fileNr){
+// Page cache residency of a set of files.
+struct CacheStats {
+	std::uint64_t pages;
+	std::uint64_t resident;
+};
+
+void addResidency(std::string const & path, CacheStats & stats)
+{
+	int const fd { open(path.c_str(), O_RDONLY) };
+	if (fd == -1) {
+		throwCacheError("open", path, errno);
+	}
+	struct stat st;
+	int e { fstat(fd, &st) == -1 ? errno : 0 };
+	char const * what { "fstat" };
+	if (e == 0 && st.st_size > 0) {
+		void * const data { mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0) };
+		if (data == MAP_FAILED) {
+			e = errno;
+			what = "mmap";
+		} else {
+			long const pageSize { sysconf(_SC_PAGESIZE) };
+			std::vector<unsigned char> vec((st.st_size + pageSize - 1) / pageSize);
+			if (mincore(data, st.st_size, vec.data()) == 0) {
+				stats.pages += vec.size();
+				stats.resident += std::count_if(vec.begin(), vec.end(),
+				                [](unsigned char const v) { return (v & 1) != 0; });
+			} else {
+				e = errno;
+				what = "mincore";
+			}
+			munmap(data, st.st_size);
+		}
+	}
+	close(fd);
+	if (e != 0) {
+		throwCacheError(what, path, e);
+	}
+}
+
+void warmFile(std::string const & path)
+{
+	int const fd { open(path.c_str(), O_RDONLY) };
+	if (fd == -1) {
+		throwCacheError("open", path, errno);
+	}
+	int e { posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) };
+	char const * what { "posix_fadvise" };
+	char buf[65536];
+	ssize_t n { };
+	while (e == 0 && ((n = read(fd, buf, sizeof buf)) > 0 || (n == -1 && errno == EINTR))) {
+	}
+	if (e == 0 && n == -1) {
+		e = errno;
+		what = "read";
+	}
+	close(fd);
+	if (e != 0) {
+		throwCacheError(what, path, e);
+	}
+}
+
+void evictFiles(std::vector<ManifestEntry> const & files, std::string const & top)
+{
+	for (auto const & f : files) {
+		evictFile(top + "/" + f.path);
+	}
+}
+
+std::string residencyText(std::vector<ManifestEntry> const & files, std::string const & top)
+{
+	CacheStats stats { };
+	for (auto const & f : files) {
+		addResidency(top + "/" + f.path, stats);
+	}
 	std::ostringstream oss;
-	oss.exceptions(osExceptions);
-	oss << "file_" << namebase << "_" << std::setw(3) << std::setfill('0') << fileNr;
+	oss << std::fixed << std::setprecision(1)
+	    << (stats.pages == 0 ? 0.0 : 100.0 * stats.resident / stats.pages) << "% of "
+	    << stats.pages << " pages cached";
 	return oss.str();
 }
 
-void mkheader(std::string const & dirbase, std::string const & namebase, int const fileNr)
+int const cacheBenchRounds { 5 };
+
+// cache evict [manifest] [prefix...]
+// cache warm [manifest] [prefix...]
+// cache status [manifest] [prefix...]
+// cache bench <manifest> <clean-command> <build-command> [prefix...]
+//
+// Puts the generated files listed in a manifest, or those below the given
+// path prefixes, in a known page cache state.  bench runs the build cold,
+// warm and, with prefixes, with only those subtrees warm, cleaning the build
+// before each run, cacheBenchRounds times, and reports the median and the
+// minimum build time per cache state.
+int cacheState(int const argc, char *argv[])
 {
-	std::string const fname(baseFilename(namebase, fileNr));
-	std::ofstream os;
+	std::string const cmd { argc > 1 ? argv[1] : "" };
+	bool const isBench { cmd == "bench" };
+	if ((cmd != "evict" && cmd != "warm" && cmd != "status" && !isBench) || (isBench && argc < 5)) {
+		std::cerr << "usage: bigprojgen cache evict|warm|status [manifest] [prefix...]\n"
+		             "       bigprojgen cache bench <manifest> <clean-command> <build-command> [prefix...]\n";
+		return EXIT_FAILURE;
+	}
+	std::string const manifestPath { argc > 2 ? argv[2] : manifestName };
+	std::map<std::string, std::string> dirs;
+	std::string parameters;
+	auto const files = readManifest(manifestPath, dirs, parameters);
+	auto const slash = manifestPath.rfind('/');
+	std::string const top { slash == std::string::npos ? "." : manifestPath.substr(0, slash) };
+	std::vector<std::string> const prefixes(argv + std::min(argc, isBench ? 5 : 3), argv + argc);
+	std::vector<ManifestEntry> selected;
+	for (auto const & f : files) {
+		if (prefixes.empty() || std::any_of(prefixes.begin(), prefixes.end(), [&f](std::string const & p) {
+			return f.path.compare(0, p.length(), p) == 0;
+		})) {
+			selected.push_back(f);
+		}
+	}
+
+	if (cmd == "evict") {
+		evictFiles(selected, top);
+	} else if (cmd == "warm") {
+		for (auto const & f : selected) {
+			warmFile(top + "/" + f.path);
+		}
+	}
+	if (!isBench) {
+		auto const residency = residencyText(selected, top);
+		std::cout << selected.size() << " files, " << residency << "\n";
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<std::pair<std::string, std::vector<ManifestEntry> const *>> states {
+		{ "cold", nullptr },
+		{ "warm", &files },
+	};
+	if (!prefixes.empty()) {
+		states.emplace_back("partially warm", &selected);
+	}
+	// An untimed build first caches the compiler and system headers for all
+	// states alike, then the states take turns so drift affects all of them.
+	runTimed(argv[3]);
+	runTimed(argv[4]);
+	std::vector<std::vector<double>> times(states.size());
+	std::vector<std::string> residency(states.size());
+	for (int round { }; round != cacheBenchRounds; ++round) {
+		for (std::size_t i { }; i != states.size(); ++i) {
+			runTimed(argv[3]);
+			evictFiles(files, top);
+			if (states[i].second != nullptr) {
+				for (auto const & f : *states[i].second) {
+					warmFile(top + "/" + f.path);
+				}
+			}
+			residency[i] = residencyText(files, top);
+			times[i].push_back(runTimed(argv[4]));
+		}
+	}
+	std::cout << std::fixed << std::setprecision(3);
+	for (std::size_t i { }; i != states.size(); ++i) {
+		std::sort(times[i].begin(), times[i].end());
+		std::cout << states[i].first << ": median " << times[i][times[i].size() / 2] << " s, min "
+		          << times[i].front() << " s of " << times[i].size() << " builds (generated files "
+		          << residency[i] << " at start)\n";
+	}
+	return EXIT_SUCCESS;
+}
+
+// The iostream formatting that formatHeader/formatSource replaced, kept as
+// the reference for bench-emit.
+std::string streamHeader(std::string const & fname, std::string const & incguard)
+{
+	std::ostringstream os;
 	os.exceptions(osExceptions);
-	os.open(dirbase + "/" + fname + headerExt);
-	std::string const incguard{mkIncludeGuard(fname)};
 	os << "#ifndef " << incguard << "\n"
 	      "#define " << incguard << "\n";
 	os << "// Copyright © " << GetCurrentYear() << " Bo Rydberg\n";
@@ -110,16 +2956,13 @@ void mkheader(std::string const & dirbase, std::string const & namebase, int con
 	      "\tint m_" << fname.substr(filePrefixLen) << ";\n"
 	      "};\n"
 	      "#endif // " << incguard << "\n";
-	Includes.push_back(fname + headerExt);
+	return os.str();
 }
 
-void mksources(std::string const & dirbase, std::string const & namebase,
-                int const fileNr, std::vector<std::string> & cppfiles)
+std::string streamSource(std::string const & fname)
 {
-	std::string const fname{baseFilename(namebase, fileNr)};
-	std::ofstream os;
+	std::ostringstream os;
 	os.exceptions(osExceptions);
-	os.open(dirbase + "/" + fname + srcExt);
 	os << "// Copyright © " << GetCurrentYear() << " Bo Rydberg\n";
 	for (auto const & s : Includes) {
 		os << "#include \"" << s << "\"\n";
@@ -140,118 +2983,501 @@ void mksources(std::string const & dirbase, std::string const & namebase,
 	      "{\n"
 	      "\t++m_" << fname.substr(filePrefixLen) << ";\n"
 	      "}\n";
-	cppfiles.push_back(fname + srcExt);
+	return os.str();
 }
 
-void mkCMakeLists(std::string const & dirbase, std::string const & namebase,
-                std::vector<std::string> const & cppfiles)
+template<typename Format>
+double nsPerCall(int const iterations, Format const & format)
 {
-	std::ofstream os;
-	os.exceptions(osExceptions);
-	os.open(dirbase + "/" + cmakeListName);
-	os << "project(Prg" << namebase << ")\n"
-			"add_library(" << namebase << libNamePostfix << "\n";
-	for (auto const & fname : cppfiles) {
-		os << "\t" << fname << "\n";
+	std::size_t bytes { };
+	auto const start = std::chrono::steady_clock::now();
+	for (int i { }; i != iterations; ++i) {
+		bytes += format().size();
+	}
+	std::chrono::duration<double, std::nano> const elapsed { std::chrono::steady_clock::now() - start };
+	if (bytes == 0) {
+		throw std::logic_error("nothing formatted");
+	}
+	return elapsed.count() / iterations;
+}
+
+// bench-emit [iterations] [includes]
+//
+// Per file cost of the template emitters against the iostream formatting,
+// for a source including <includes> headers.
+int benchEmit(int const argc, char *argv[])
+{
+	int iterations { 20000 }, nrIncludes { 100 };
+	if ((argc > 1 && !parsePositive(argv[1], iterations))
+	    || (argc > 2 && !parsePositive(argv[2], nrIncludes))) {
+		std::cerr << "usage: bigprojgen bench-emit [iterations] [includes]\n";
+		return EXIT_FAILURE;
+	}
+	Includes.clear();
+	for (int i { }; i < nrIncludes; ++i) {
+		Includes.push_back(baseFilename("a", i) + headerExt);
+	}
+	std::string const fname { baseFilename("b", 42) };
+	std::string const incguard { mkIncludeGuard(fname) };
+	if (formatHeader(fname, incguard) != streamHeader(fname, incguard)
+	    || formatSource(fname) != streamSource(fname)) {
+		throw std::logic_error("template and iostream output differ");
+	}
+	int const n { iterations };
+	std::cout << std::fixed << std::setprecision(1)
+	          << "header  template " << nsPerCall(n, [&] { return formatHeader(fname, incguard); })
+	          << " ns  iostream " << nsPerCall(n, [&] { return streamHeader(fname, incguard); }) << " ns\n"
+	          << "source  template " << nsPerCall(n, [&] { return formatSource(fname); })
+	          << " ns  iostream " << nsPerCall(n, [&] { return streamSource(fname); }) << " ns\n";
+	Includes.clear();
+	return EXIT_SUCCESS;
+}
+
+// One measurement of the bench suite, as written to its JSON result.
+struct BenchResult {
+	std::string name;
+	double seconds;
+	std::vector<std::pair<std::string, double>> metrics;
+	// Range of the samples relative to the median, see medianOf.
+	double spread { };
+	// Whether the regression check applies; runs of a few milliseconds are
+	// dominated by process startup and scheduling, so they are only reported.
+	bool gated { true };
+};
+
+// A complete generation run into dir in a child process, so that its peak
+// memory can be measured on its own.  The tree is left for the caller.
+BenchResult benchGenerate(std::string const & dir, int const depth, char const dirRangeEnd, int const nrFiles)
+{
+	int fds[2];
+	if (pipe(fds) == -1) {
+		throw std::runtime_error("`pipe' failed");
+	}
+	auto const start = std::chrono::steady_clock::now();
+	pid_t const pid { fork() };
+	if (pid == 0) {
+		close(fds[0]);
+		try {
+			mkDir(dir);
+			WorkingDir const wd { dir };
+			generate(depth, dirRangeEnd, nrFiles, false);
+			std::uint64_t const bytes { BytesWritten };
+			_exit(write(fds[1], &bytes, sizeof bytes) == sizeof bytes ? EXIT_SUCCESS : EXIT_FAILURE);
+		} catch (...) {
+			_exit(EXIT_FAILURE);
+		}
+	}
+	close(fds[1]);
+	std::uint64_t bytes { };
+	bool const gotBytes = pid != -1 && read(fds[0], &bytes, sizeof bytes) == sizeof bytes;
+	close(fds[0]);
+	int status { };
+	struct rusage ru { };
+	if (pid == -1 || wait4(pid, &status, 0, &ru) == -1 || !WIFEXITED(status)
+	    || WEXITSTATUS(status) != EXIT_SUCCESS || !gotBytes) {
+		throw std::runtime_error("benchmark generation into " + dir + " failed");
+	}
+	std::chrono::duration<double> const elapsed { std::chrono::steady_clock::now() - start };
+	BuildShape const shape { depth, dirRangeEnd - 'a' + 1, nrFiles };
+	double const files { 2 * nrTUs(shape) + nrModules(shape) + 1 };
+	std::ostringstream name;
+	name << "generate/depth" << depth << "-range" << shape.range << "-files" << nrFiles;
+	return BenchResult { name.str(), elapsed.count(), {
+		{ "files_per_second", files / elapsed.count() },
+		{ "mib_per_second", bytes / elapsed.count() / (1 << 20) },
+		{ "peak_rss_kib", static_cast<double>(ru.ru_maxrss) },
+	} };
+}
+
+// Number of samples every figure is the median of.
+int const benchSamples { 5 };
+
+// The median of a few samples, with their range relative to it as the noise
+// the regression check allows for on top of its tolerance.
+template<typename Run>
+BenchResult medianOf(int const runs, Run const & run)
+{
+	std::vector<BenchResult> samples;
+	for (int i { }; i != runs; ++i) {
+		samples.push_back(run());
+	}
+	std::sort(samples.begin(), samples.end(), [](BenchResult const & a, BenchResult const & b) {
+		return a.seconds < b.seconds;
+	});
+	BenchResult median { samples[samples.size() / 2] };
+	median.spread = (samples.back().seconds - samples.front().seconds) / median.seconds;
+	return median;
+}
+
+// Shortest wall time a benchmark figure is averaged over.
+double const minBenchSeconds { 0.1 };
+
+// The mean of repeated runs lasting at least minBenchSeconds together, so
+// that short runs are not dominated by timer and scheduler noise.
+template<typename Run>
+BenchResult meanOver(Run const & run)
+{
+	auto const start = std::chrono::steady_clock::now();
+	auto const elapsed = [start] {
+		return std::chrono::duration<double> { std::chrono::steady_clock::now() - start }.count();
 	};
-	os << ")\n";
-	os << "target_include_directories(" << namebase << libNamePostfix
-	                << " PUBLIC \"$<BUILD_INTERFACE:${Prg" << namebase
-	                << "_SOURCE_DIR}>\"\n";
-	for(auto const & nb : NameBases) {
-		os << "\t\"$<BUILD_INTERFACE:${Prg" << nb << "_SOURCE_DIR}>\"\n";
-	}
-	os << ")\n";
-	NameBases.push_back(namebase);
+	BenchResult mean { run() };
+	int n { 1 };
+	for (; elapsed() < minBenchSeconds; ++n) {
+		auto const r = run();
+		mean.seconds += r.seconds;
+		for (std::size_t i { }; i != mean.metrics.size(); ++i) {
+			mean.metrics[i].second += r.metrics[i].second;
+		}
+	}
+	mean.seconds /= n;
+	for (auto & m : mean.metrics) {
+		m.second /= n;
+	}
+	return mean;
 }
 
-void mkfiles(std::string const & dirbase, std::string const & namebase, int const nrFiles)
+template<typename Format>
+BenchResult benchEmitter(std::string const & name, Format const & format)
 {
-	std::vector<std::string> cppfiles;
-	for (int i { }; i != nrFiles; ++i) {
-		mkheader(dirbase, namebase, i);
-		mksources(dirbase, namebase, i, cppfiles);
+	return medianOf(benchSamples, [&] {
+		return meanOver([&] {
+			double const ns { nsPerCall(1000, format) };
+			return BenchResult { "emit/" + name, ns / 1e9, { { "ns_per_file", ns } } };
+		});
+	});
+}
+
+// Emitter cost per file type, for a TU including 100 headers in the 51st
+// module.
+std::vector<BenchResult> benchEmitters()
+{
+	Includes.clear();
+	NameBases.clear();
+	ModuleDirs.clear();
+	for (int i { }; i != 100; ++i) {
+		Includes.push_back(baseFilename("a", i) + headerExt);
+	}
+	for (int i { }; i != 50; ++i) {
+		NameBases.push_back(std::string { static_cast<char>('a' + i / 26), static_cast<char>('a' + i % 26) });
+		ModuleDirs.push_back(moduleDir(NameBases.back()));
+	}
+	std::string const fname { baseFilename("cz", 42) };
+	std::string const incguard { mkIncludeGuard(fname) };
+	std::vector<std::string> cppfiles, fnames;
+	for (int i { }; i != 100; ++i) {
+		fnames.push_back(baseFilename("cz", i));
+		cppfiles.push_back(fnames.back() + srcExt);
 	}
-	mkCMakeLists(dirbase, namebase, cppfiles);
-	MODULES += " " + dirbase.substr(2);
+	std::vector<BenchResult> results {
+		benchEmitter("header", [&] { return formatHeader(fname, incguard); }),
+		benchEmitter("source", [&] { return formatSource(fname); }),
+		benchEmitter("cmakelists", [&] { return formatCMakeLists("cz", cppfiles); }),
+		benchEmitter("recursive-make", [&] { return formatRecursiveMakefile("cz", fnames, ModuleDirs); }),
+		benchEmitter("nonharmful-make", [&] { return formatNonHarmfulMakefile("cz", fnames, ModuleDirs); }),
+		benchEmitter("jb-make", [&] { return formatJbLeafMakefile(ModuleDirs); }),
+	};
+	Includes.clear();
+	NameBases.clear();
+	ModuleDirs.clear();
+	return results;
 }
 
-void mkDir(std::string const & dirLocation)
+// Manifest verification of one tree with growing thread counts.
+std::vector<BenchResult> benchVerify(std::string const & dir)
 {
-	if (mkdir(dirLocation.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) == -1) {
-		auto const e = errno;
-		std::ostringstream oss;
-		oss << "`mkdir(\"" << dirLocation
-		    << "\", S_IRWXU | S_IRWXG | S_IRWXO)' failed with errno " << e;
-		throw std::runtime_error(oss.str());
+	Options.manifest = true;
+	auto gen = medianOf(benchSamples, [&] {
+		return meanOver([&] {
+			struct stat st;
+			if (stat(dir.c_str(), &st) == 0) {
+				rmTree(dir);
+			}
+			return benchGenerate(dir, 2, 'h', 10);
+		});
+	});
+	Options.manifest = false;
+	gen.name += "-manifest";
+	std::vector<BenchResult> results { gen };
+	std::map<std::string, std::string> dirs;
+	std::string parameters;
+	auto const files = readManifest(dir + "/" + manifestName, dirs, parameters);
+	for (int threads { 1 }; threads <= 8; threads *= 2) {
+		results.push_back(medianOf(benchSamples, [&] {
+			return meanOver([&] {
+				std::vector<char> readable;
+				auto const start = std::chrono::steady_clock::now();
+				hashFilesParallel(dir, files, threads, readable);
+				std::chrono::duration<double> const elapsed { std::chrono::steady_clock::now() - start };
+				if (std::count(readable.begin(), readable.end(), 0) != 0) {
+					throw std::runtime_error("benchmark tree in " + dir + " incomplete");
+				}
+				return BenchResult { "verify/threads" + std::to_string(threads), elapsed.count(),
+				                { { "files_per_second", files.size() / elapsed.count() } } };
+			});
+		}));
 	}
+	rmTree(dir);
+	return results;
 }
 
-void mkDirRange(int const depth, std::string const & dirbase, std::string const & namebase,
-		char const a, char const z, int const nrFiles)
+// Seconds and spread per benchmark name from a JSON result written by bench.
+std::map<std::string, BenchResult> readBenchResults(std::string const & path)
 {
-	if (depth <= 0) {
-		return mkfiles(dirbase, namebase, nrFiles);
+	std::ifstream ifs(path);
+	if (!ifs) {
+		throw std::runtime_error("could not read baseline " + path);
 	}
-	std::string d(dirbase + "/directory_" + namebase);
-	auto const len = d.length();
-	for (auto i = a; i <= z; ++i) {
-		d.resize(len);
-		d += i;
-		mkDir(d);
-		mkDirRange(depth - 1, d, namebase + i, a, z, nrFiles);
+	std::ostringstream oss;
+	oss << ifs.rdbuf();
+	std::string const json { oss.str() };
+	std::map<std::string, BenchResult> results;
+	std::string const nameKey { "\"name\": \"" }, secondsKey { "\"seconds\": " },
+	                  spreadKey { "\"spread\": " };
+	for (auto pos = json.find(nameKey); pos != std::string::npos; pos = json.find(nameKey, pos)) {
+		pos += nameKey.length();
+		auto const name = json.substr(pos, json.find('"', pos) - pos);
+		auto const end = json.find('}', pos);
+		auto const value = [&](std::string const & key) {
+			auto const at = json.find(key, pos);
+			return at < end ? std::strtod(json.c_str() + at + key.length(), nullptr) : 0.0;
+		};
+		results[name] = BenchResult { name, value(secondsKey), { }, value(spreadKey) };
 	}
+	return results;
 }
 
-void mkMainCMakeListsFile()
+// bench [dir] [result.json] [tolerance] [baseline.json]
+//
+// Measures generation throughput and peak memory when scaling depth, range
+// and files per directory, emitter cost per file type and verification with
+// growing thread counts, generating below dir (default /dev/shm, a tmpfs).
+// Every figure is the median of benchSamples means over at least
+// minBenchSeconds of repeated runs.  With a baseline, fails when a gated
+// benchmark got slower by more than tolerance (default 0.25, that is 25%)
+// plus the larger spread of the baseline and this run.
+int bench(int const argc, char *argv[])
 {
-	std::ofstream os;
+	std::string const base { argc > 1 ? argv[1] : "/dev/shm" };
+	std::string const resultPath { argc > 2 ? argv[2] : "bench.json" };
+	double tolerance { 0.25 };
+	if (argc > 3 && !parsePositive(argv[3], tolerance)) {
+		std::cerr << "usage: bigprojgen bench [dir] [result.json] [tolerance] [baseline.json]\n";
+		return EXIT_FAILURE;
+	}
+	std::string const dir { base + "/bigprojgen-bench-" + std::to_string(getpid()) };
+	struct Shape {
+		int depth;
+		char dirRangeEnd;
+		int nrFiles;
+		bool gated;
+	};
+	// The scaling series; only shapes whose single run takes about 100 ms or
+	// longer are gated.
+	Shape const shapes[] {
+		{ 1, 'd', 20, false }, { 2, 'd', 20, false }, { 3, 'd', 20, true },
+		{ 2, 'b', 20, false }, { 2, 'h', 20, true },
+		{ 2, 'd', 5, false }, { 2, 'd', 80, true },
+	};
+	std::vector<BenchResult> results;
+	for (auto const & shape : shapes) {
+		results.push_back(medianOf(benchSamples, [&] {
+			return meanOver([&] {
+				auto const r = benchGenerate(dir, shape.depth, shape.dirRangeEnd, shape.nrFiles);
+				rmTree(dir);
+				return r;
+			});
+		}));
+		results.back().gated = shape.gated;
+		std::cerr << results.back().name << ": " << results.back().seconds << " s\n";
+	}
+	for (auto const & r : benchEmitters()) {
+		results.push_back(r);
+	}
+	for (auto const & r : benchVerify(dir)) {
+		results.push_back(r);
+	}
+
+	std::ostringstream os;
 	os.exceptions(osExceptions);
-	os.open(&cmakeListName[0]);
-	os << "cmake_minimum_required(VERSION 2.8)\n"
-	      "project(BigThing)\n";
-	std::istringstream iss(MODULES);
-	std::string module;
-	while (iss >> module) {
-		os << "add_subdirectory(" << module << ")\n";
+	os << std::setprecision(6) << "{\n  \"version\": 2,\n  \"benchmarks\": [\n";
+	for (std::size_t i { }; i != results.size(); ++i) {
+		auto const & r = results[i];
+		os << "    { \"name\": \"" << r.name << "\", \"seconds\": " << r.seconds
+		   << ", \"spread\": " << r.spread << ", \"gated\": " << (r.gated ? "true" : "false");
+		for (auto const & m : r.metrics) {
+			os << ", \"" << m.first << "\": " << m.second;
+		}
+		os << (i + 1 == results.size() ? " }\n" : " },\n");
+	}
+	os << "  ]\n}\n";
+	std::ofstream ofs;
+	ofs.exceptions(osExceptions);
+	ofs.open(resultPath);
+	ofs << os.str();
+	std::cerr << "Results written to " << resultPath << "\n";
+
+	if (argc <= 4) {
+		return EXIT_SUCCESS;
+	}
+	auto const baseline = readBenchResults(argv[4]);
+	int regressions { };
+	for (auto const & r : results) {
+		auto const b = baseline.find(r.name);
+		if (!r.gated || b == baseline.end()) {
+			continue;
+		}
+		double const limit { b->second.seconds * (1 + tolerance + std::max(r.spread, b->second.spread)) };
+		if (r.seconds > limit) {
+			std::cerr << "REGRESSION " << r.name << ": " << r.seconds << " s against baseline "
+			          << b->second.seconds << " s, limit " << limit << " s\n";
+			++regressions;
+		}
 	}
+	std::cerr << regressions << " regressions beyond " << 100 * tolerance << "% plus noise\n";
+	return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-int getDepth(int const argc, char *argv[])
+// Removes the `--name=value' and `--name' arguments from argv, returning them
+// by name; the remaining arguments are positional.
+std::multimap<std::string, std::string> extractOptions(int & argc, char *argv[])
 {
-	if (argc > 1) {
-		std::istringstream iss(argv[1]);
-		int depth;
-		if (iss >> depth && depth > 0 && iss.eof()) {
-			return depth;
+	std::multimap<std::string, std::string> options;
+	int kept { 1 };
+	for (int i { 1 }; i < argc; ++i) {
+		std::string const arg { argv[i] };
+		if (arg.compare(0, 2, "--") != 0) {
+			argv[kept++] = argv[i];
+			continue;
 		}
+		auto const eq = arg.find('=');
+		options.emplace(arg.substr(2, eq == std::string::npos ? eq : eq - 2),
+		                eq == std::string::npos ? std::string() : arg.substr(eq + 1));
 	}
-	int const defaultDepth = 1;
-	std::cerr << "Using default depth of " << defaultDepth << "\n";
-	return defaultDepth;
+	argc = kept;
+	argv[argc] = nullptr;
+	return options;
 }
 
-char getDirRangeEnd(int const argc, char *argv[])
+// --jb-configs=<config>[,<config>...] with predefined configurations debug,
+// release and sanitize, or as the last one <name>:<flags> for any other set
+// of flags; the flags extend to the end of the value, commas included.  The
+// option may be repeated, each adding to configs.
+void parseJbConfigs(std::string const & list, std::vector<JbConfig> & configs)
 {
-	if (argc > 2) {
-		std::istringstream iss(argv[2]);
-		char theEnd;
-		if (iss >> theEnd && 'a' <= theEnd && theEnd <= 'z') {
-			return theEnd;
+	JbConfig const predefined[] {
+		{ "debug", "-O0 -g" },
+		{ "release", "-O2 -DNDEBUG" },
+		{ "sanitize", "-O1 -g -fno-omit-frame-pointer -fsanitize=address,undefined" },
+	};
+	std::string::size_type pos { };
+	while (pos < list.length()) {
+		auto const comma = list.find(',', pos);
+		auto const colon = list.find(':', pos);
+		bool const custom { colon < comma };
+		auto const end = custom || comma == std::string::npos ? list.length() : comma;
+		std::string const spec { list.substr(pos, end - pos) };
+		pos = end + 1;
+		auto const nameEnd = custom ? spec.find(':') : std::string::npos;
+		JbConfig cfg { spec.substr(0, nameEnd), custom ? spec.substr(nameEnd + 1) : "" };
+		if (cfg.name.empty() || cfg.name.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789_") != std::string::npos) {
+			throw std::runtime_error("--jb-configs needs lower case configuration names, got " + spec);
+		}
+		if (!custom) {
+			auto const p = std::find_if(std::begin(predefined), std::end(predefined),
+			                [&cfg](JbConfig const & c) { return c.name == cfg.name; });
+			if (p == std::end(predefined)) {
+				throw std::runtime_error("unknown --jb-configs configuration " + spec);
+			}
+			cfg = *p;
+		}
+		if (std::any_of(configs.begin(), configs.end(), [&cfg](JbConfig const & c) { return c.name == cfg.name; })) {
+			throw std::runtime_error("duplicate --jb-configs configuration " + cfg.name);
 		}
+		configs.push_back(cfg);
+	}
+	if (configs.empty()) {
+		throw std::runtime_error("--jb-configs needs at least one configuration");
 	}
-	char const defaultEnd = 'a';
-	std::cerr << "Using default range of 'a'..'" << defaultEnd << "'\n";
-	return defaultEnd;
 }
 
-} // namespace
+void applyOptions(std::multimap<std::string, std::string> const & options)
+{
+	for (auto const & opt : options) {
+		if (opt.first == "template") {
+			loadTemplate(opt.second);
+		} else if (opt.first == "resume") {
+			Options.resume = true;
+		} else if (opt.first == "year") {
+			std::istringstream iss(opt.second);
+			if (!(iss >> Options.year) || Options.year <= 0 || !iss.eof()) {
+				throw std::runtime_error("--year needs a positive year, got " + opt.second);
+			}
+		} else if (opt.first == "manifest") {
+			Options.manifest = true;
+		} else if (opt.first == "evict") {
+			Options.evict = true;
+		} else if (opt.first == "emit") {
+			Options.emit = parseEmit(opt.second);
+		} else if (opt.first == "jb-configs") {
+			parseJbConfigs(opt.second, Options.jbConfigs);
+		} else {
+			throw std::runtime_error("unknown option --" + opt.first);
+		}
+	}
+	if (!Options.jbConfigs.empty() && !(Options.emit & EmitJb)) {
+		throw std::runtime_error("--jb-configs needs --emit with jb");
+	}
+}
 
-int main(int argc, char *argv[])
+// Runs the subcommand or generation given on the command line.
+int run(int argc, char *argv[])
 {
+	applyOptions(extractOptions(argc, argv));
+	if (argc > 1 && std::strcmp(argv[1], "cache") == 0) {
+		return cacheState(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "calibrate") == 0) {
+		return calibrate(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+		return bench(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "bench-emit") == 0) {
+		return benchEmit(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "cachefamily") == 0) {
+		return cacheFamily(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "verify") == 0) {
+		return verify(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "ingest") == 0) {
+		return ingest(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "serve") == 0) {
+		return serve(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "request") == 0) {
+		return request(argc - 1, argv + 1);
+	}
 	auto const depth = getDepth(argc, argv);
 	auto const dirRangeEnd = getDirRangeEnd(argc, argv);
-	mkDirRange(depth, ".", "", 'a', dirRangeEnd, 100);
-	mkMainCMakeListsFile();
+	auto const nrFiles = getFilesPerDir(argc, argv);
+	generate(depth, dirRangeEnd, nrFiles, Options.resume);
 	return EXIT_SUCCESS;
 }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	// Errors are reported as exceptions; a message and a failing exit status
+	// are all that is needed for them, and the stack is unwound on the way.
+	try {
+		return run(argc, argv);
+	} catch (std::exception const & e) {
+		std::cerr << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,154 @@
+// Copyright © 2015 Bo Rydberg
+#ifndef TEMPLATE_H_INCLUDED_
+#define TEMPLATE_H_INCLUDED_
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Output text with placeholders `~0' .. `~9', each replaced by the argument
+// with that index when rendered, and `~~' for a literal `~'.  Templates written as string literals are
+// parsed by the constexpr constructor at compile time, custom templates read
+// at startup are parsed once by the same constructor at run time.  Either
+// way rendering is a sequence of sized appends, no scanning of the text.
+class Template {
+public:
+	static char const marker { '~' };
+	static int const maxSlots { 32 };
+	static int const maxArgs { 10 };
+
+	template<std::size_t N>
+	constexpr Template(char const (&text)[N]) :
+			Template(text, N - 1)
+	{
+	}
+
+	constexpr Template(char const * text, std::size_t size) :
+			m_text(text), m_size(size), m_staticSize(size), m_nrArgs(),
+			m_nrSlots(), m_slotPos(), m_slotArg()
+	{
+		for (std::size_t i { }; i != size; ++i) {
+			if (text[i] != marker) {
+				continue;
+			}
+			bool const literal { i + 1 != size && text[i + 1] == marker };
+			if (!literal && (i + 1 == size || text[i + 1] < '0' || '9' < text[i + 1])) {
+				throw std::invalid_argument("template marker not followed by a digit or marker");
+			}
+			if (m_nrSlots == maxSlots) {
+				throw std::invalid_argument("too many template placeholders");
+			}
+			// A literal marker is kept as a slot rendering the marker itself.
+			int const arg { literal ? literalSlot : text[i + 1] - '0' };
+			m_slotPos[m_nrSlots] = i;
+			m_slotArg[m_nrSlots] = arg;
+			++m_nrSlots;
+			m_nrArgs = arg + 1 > m_nrArgs ? arg + 1 : m_nrArgs;
+			m_staticSize -= literal ? 1 : 2;
+			++i;
+		}
+	}
+
+	// Number of arguments the template refers to, highest index plus one.
+	constexpr int nrArgs() const { return m_nrArgs; }
+	constexpr char const * text() const { return m_text; }
+	constexpr std::size_t size() const { return m_size; }
+
+	// A piece of text substituted for a placeholder; not owning.
+	struct Arg {
+		Arg(std::string const & s) : data(s.data()), size(s.size()) { }
+		Arg(char const * s) : data(s), size(std::strlen(s)) { }
+		Arg(char const * s, std::size_t n) : data(s), size(n) { }
+		char const * data;
+		std::size_t size;
+	};
+
+	std::size_t renderedSize(Arg const * args, int const nrArgs) const
+	{
+		checkArgs(nrArgs);
+		std::size_t size { m_staticSize };
+		for (int i { }; i != m_nrSlots; ++i) {
+			size += m_slotArg[i] == literalSlot ? 0 : args[m_slotArg[i]].size;
+		}
+		return size;
+	}
+
+	void appendTo(std::string & out, Arg const * args, int const nrArgs) const
+	{
+		checkArgs(nrArgs);
+		std::size_t pos { };
+		for (int i { }; i != m_nrSlots; ++i) {
+			out.append(m_text + pos, m_slotPos[i] - pos);
+			if (m_slotArg[i] == literalSlot) {
+				out += marker;
+			} else {
+				out.append(args[m_slotArg[i]].data, args[m_slotArg[i]].size);
+			}
+			pos = m_slotPos[i] + 2;
+		}
+		out.append(m_text + pos, m_size - pos);
+	}
+
+private:
+	static int const literalSlot { -1 };
+
+	void checkArgs(int const nrArgs) const
+	{
+		if (nrArgs < m_nrArgs) {
+			throw std::invalid_argument("template needs " + std::to_string(m_nrArgs)
+			                            + " arguments, got " + std::to_string(nrArgs));
+		}
+	}
+
+	char const * m_text;
+	std::size_t m_size;
+	std::size_t m_staticSize;
+	int m_nrArgs;
+	int m_nrSlots;
+	std::size_t m_slotPos[maxSlots];
+	int m_slotArg[maxSlots];
+};
+
+// Sinks an emitter is run against, first to size the output, then to fill it.
+class TemplateSizer {
+public:
+	template<typename... Args>
+	void operator()(Template const & tpl, Args const &... args)
+	{
+		Template::Arg const a[] { Template::Arg(args)..., Template::Arg("") };
+		m_size += tpl.renderedSize(a, sizeof...(Args));
+	}
+	std::size_t size() const { return m_size; }
+private:
+	std::size_t m_size { };
+};
+
+class TemplateWriter {
+public:
+	explicit TemplateWriter(std::string & out) : m_out(out) { }
+	template<typename... Args>
+	void operator()(Template const & tpl, Args const &... args)
+	{
+		Template::Arg const a[] { Template::Arg(args)..., Template::Arg("") };
+		tpl.appendTo(m_out, a, sizeof...(Args));
+	}
+private:
+	std::string & m_out;
+};
+
+// Runs emit(sink) twice and returns the text it produces, allocated once.
+// emit must produce the same sequence of templates and arguments each time.
+template<typename Emit>
+std::string render(Emit const & emit)
+{
+	TemplateSizer sizer;
+	emit(sizer);
+	std::string out;
+	out.reserve(sizer.size());
+	TemplateWriter writer { out };
+	emit(writer);
+	return out;
+}
+
+#endif // TEMPLATE_H_INCLUDED_